@@ -0,0 +1,66 @@
+using BenchmarkDotNet.Attributes;
+using LibArchive.Net;
+
+namespace Bench.LibArchive.Net;
+
+/// <summary>
+/// Reading a spread of wanted files from a solid 7z archive: a reader per file, which decompresses
+/// everything before each one again, against a single Process pass
+/// </summary>
+[Config(typeof(BenchConfig))]
+public class BatchBenchmarks
+{
+    private readonly byte[] buffer = new byte[1 << 16];
+    private string[] wanted = null!;
+
+    [ParamsSource(nameof(Inputs))]
+    public BenchInput Input { get; set; } = null!;
+
+    public static IEnumerable<BenchInput> Inputs() => Corpus.All().Where(i => i.Name is "7z" or "tar.zst");
+
+    [Params(4, 16)]
+    public int Files { get; set; }
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        using var lar = new LibArchiveReader(Input.Path);
+        var files = lar.List().Where(e => e.Type == EntryType.File).Select(e => e.Name).ToList();
+        wanted = Enumerable.Range(0, Files).Select(i => files[(i + 1) * files.Count / Files - 1]).ToArray();
+    }
+
+    [Benchmark(Baseline = true)]
+    public long ReaderPerFile()
+    {
+        long total = 0;
+        foreach (var name in wanted)
+        {
+            using var lar = new LibArchiveReader(Input.Path);
+            foreach (var e in lar.Entries())
+                if (e.Name == name)
+                {
+                    total += Drain(e.Stream);
+                    break;
+                }
+        }
+        return total;
+    }
+
+    [Benchmark]
+    public long Process()
+    {
+        long total = 0;
+        using var lar = new LibArchiveReader(Input.Path);
+        lar.Process(wanted, e => total += Drain(e.Stream));
+        return total;
+    }
+
+    private long Drain(Stream s)
+    {
+        long total = 0;
+        int r;
+        while ((r = s.Read(buffer)) > 0)
+            total += r;
+        return total;
+    }
+}
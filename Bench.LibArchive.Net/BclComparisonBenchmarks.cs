@@ -0,0 +1,61 @@
+using System.IO.Compression;
+using BenchmarkDotNet.Attributes;
+using LibArchive.Net;
+
+namespace Bench.LibArchive.Net;
+
+/// <summary>
+/// LibArchive.Net against System.IO.Compression on the formats both can read
+/// </summary>
+[Config(typeof(BenchConfig))]
+public class BclComparisonBenchmarks
+{
+    private readonly byte[] buffer = new byte[1 << 16];
+
+    [ParamsSource(nameof(Inputs))]
+    public BenchInput Input { get; set; } = null!;
+
+    public static IEnumerable<BenchInput> Inputs() => Corpus.All().Where(i => i.Name is "tar.gz" or "zip");
+
+    [Benchmark(Baseline = true)]
+    public long LibArchive()
+    {
+        long total = 0;
+        using var lar = new LibArchiveReader(Input.Path);
+        foreach (var e in lar.Entries())
+        {
+            using var s = e.Stream;
+            total += Drain(s);
+        }
+        return total;
+    }
+
+    [Benchmark]
+    public long SystemIoCompression()
+    {
+        if (Input.Name == "zip")
+        {
+            long total = 0;
+            using var zip = ZipFile.OpenRead(Input.Path);
+            foreach (var e in zip.Entries)
+            {
+                using var s = e.Open();
+                total += Drain(s);
+            }
+            return total;
+        }
+
+        // No tar reader in the BCL before .NET 7: count the decompressed tar stream, headers included
+        using var gz = new GZipStream(File.OpenRead(Input.Path), CompressionMode.Decompress);
+        return Drain(gz);
+    }
+
+    private long Drain(Stream s)
+    {
+        long total = 0;
+        int r;
+        while ((r = s.Read(buffer.AsSpan())) > 0)
+            total += r;
+        return total;
+    }
+}
@@ -0,0 +1,13 @@
+using BenchmarkDotNet.Configs;
+using BenchmarkDotNet.Diagnosers;
+
+namespace Bench.LibArchive.Net;
+
+public sealed class BenchConfig : ManualConfig
+{
+    public BenchConfig()
+    {
+        AddDiagnoser(MemoryDiagnoser.Default);
+        AddColumn(new ThroughputColumn());
+    }
+}
@@ -0,0 +1,194 @@
+using System.IO.Compression;
+using System.Text;
+using LibArchive.Net;
+
+namespace Bench.LibArchive.Net;
+
+/// <summary>
+/// One archive to benchmark against; ToString() is the name shown in results
+/// </summary>
+public sealed class BenchInput
+{
+    public string Name { get; }
+    public string Path { get; }
+
+    public BenchInput(string name, string path)
+    {
+        Name = name;
+        Path = path;
+    }
+
+    public override string ToString() => Name;
+}
+
+/// <summary>
+/// Deterministic benchmark corpus: a tree of files mixing compressible text and incompressible noise,
+/// packed into each supported format. Generated once under the temp directory and reused by every
+/// benchmark process. Set LIBARCHIVE_BENCH_SIZE_MB to change the corpus size, and
+/// LIBARCHIVE_BENCH_INPUTS to a directory of extra archives (rar sets, real-world data) to include.
+/// </summary>
+public static class Corpus
+{
+    private static readonly int SizeMb = int.TryParse(Environment.GetEnvironmentVariable("LIBARCHIVE_BENCH_SIZE_MB"), out var mb) ? mb : 32;
+    private static readonly string Root = System.IO.Path.Combine(System.IO.Path.GetTempPath(), $"libarchive-net-bench-{SizeMb}");
+    private static readonly string Files = System.IO.Path.Combine(Root, "files");
+    private static readonly object Lock = new();
+
+    /// <summary>
+    /// Formats the BCL cannot write, built with LibArchiveWriter
+    /// </summary>
+    private static readonly (string Name, ArchiveFormat Format, ArchiveFilter Filter)[] Written =
+    {
+        ("tar.zst", ArchiveFormat.Tar, ArchiveFilter.Zstd),
+        ("tar.xz", ArchiveFormat.Tar, ArchiveFilter.Xz),
+        ("7z", ArchiveFormat.SevenZip, ArchiveFilter.None)
+    };
+
+    public static IEnumerable<BenchInput> All()
+    {
+        lock (Lock)
+        {
+            Generate();
+            var inputs = new List<BenchInput>();
+            foreach (var name in new[] { "tar", "tar.gz", "zip" }.Concat(Written.Select(e => e.Name)))
+            {
+                var path = System.IO.Path.Combine(Root, $"corpus.{name}");
+                if (File.Exists(path))
+                    inputs.Add(new BenchInput(name, path));
+            }
+
+            var extra = Environment.GetEnvironmentVariable("LIBARCHIVE_BENCH_INPUTS");
+            if (extra is not null && Directory.Exists(extra))
+                inputs.AddRange(Directory.GetFiles(extra).OrderBy(f => f).Select(f => new BenchInput(System.IO.Path.GetFileName(f), f)));
+            return inputs;
+        }
+    }
+
+    public static BenchInput Get(string name) => All().First(i => i.Name == name);
+
+    /// <summary>
+    /// Total uncompressed bytes in an input, measured once and cached beside the corpus
+    /// </summary>
+    public static long UncompressedBytes(BenchInput input)
+    {
+        var cache = System.IO.Path.Combine(Root, $"{input.Name}.size");
+        if (File.Exists(cache) && long.TryParse(File.ReadAllText(cache), out var size))
+            return size;
+        size = 0;
+        var buffer = new byte[1 << 16];
+        using (var lar = new LibArchiveReader(input.Path))
+            foreach (var e in lar.Entries())
+            {
+                using var s = e.Stream;
+                int r;
+                while ((r = s.Read(buffer.AsSpan())) > 0)
+                    size += r;
+            }
+        Directory.CreateDirectory(Root);
+        File.WriteAllText(cache, size.ToString());
+        return size;
+    }
+
+    private static void Generate()
+    {
+        var done = System.IO.Path.Combine(Root, ".complete");
+        if (File.Exists(done))
+            return;
+        if (Directory.Exists(Root))
+            Directory.Delete(Root, true);
+        Directory.CreateDirectory(Files);
+
+        var random = new Random(42);
+        var words = Enumerable.Range(0, 2048).Select(_ => new string(Enumerable.Range(0, random.Next(2, 10))
+            .Select(_ => (char)('a' + random.Next(26))).ToArray())).ToArray();
+        long remaining = (long)SizeMb << 20;
+        for (var i = 0; remaining > 0; i++)
+        {
+            var size = (int)Math.Min(remaining, random.Next(1, 1 << 20));
+            var data = new byte[size];
+            if (i % 5 == 4)
+                random.NextBytes(data);
+            else
+            {
+                var sb = new StringBuilder(size + 16);
+                while (sb.Length < size)
+                    sb.Append(words[random.Next(words.Length)]).Append(random.Next(12) == 0 ? '\n' : ' ');
+                Encoding.ASCII.GetBytes(sb.ToString(0, size), data);
+            }
+            var dir = System.IO.Path.Combine(Files, $"d{i % 16:x}");
+            Directory.CreateDirectory(dir);
+            File.WriteAllBytes(System.IO.Path.Combine(dir, $"f{i:d5}.dat"), data);
+            remaining -= size;
+        }
+
+        var tar = System.IO.Path.Combine(Root, "corpus.tar");
+        using (var output = File.Create(tar))
+            WriteTar(output);
+        using (var input = File.OpenRead(tar))
+        using (var output = new GZipStream(File.Create(System.IO.Path.Combine(Root, "corpus.tar.gz")), CompressionLevel.Optimal))
+            input.CopyTo(output);
+        ZipFile.CreateFromDirectory(Files, System.IO.Path.Combine(Root, "corpus.zip"), CompressionLevel.Optimal, false);
+
+        foreach (var (name, format, filter) in Written)
+        {
+            using var writer = new LibArchiveWriter(System.IO.Path.Combine(Root, $"corpus.{name}"), format, filter, threads: filter == ArchiveFilter.None ? 0 : Environment.ProcessorCount);
+            foreach (var (path, file) in CorpusFiles())
+                writer.AddFile(path, File.ReadAllBytes(file));
+            writer.Finish();
+        }
+
+        File.WriteAllText(done, "");
+    }
+
+    /// <summary>
+    /// The uncompressed corpus files as (archive path, file path), in a fixed order
+    /// </summary>
+    public static IReadOnlyList<(string Name, string Path)> SourceFiles()
+    {
+        lock (Lock)
+        {
+            Generate();
+            return CorpusFiles().ToList();
+        }
+    }
+
+    private static IEnumerable<(string Name, string Path)> CorpusFiles()
+    {
+        return Directory.GetFiles(Files, "*", SearchOption.AllDirectories).OrderBy(f => f, StringComparer.Ordinal)
+            .Select(f => (System.IO.Path.GetRelativePath(Files, f).Replace('\\', '/'), f));
+    }
+
+    /// <summary>
+    /// Minimal ustar writer, so the plain tar input does not depend on any external tool
+    /// </summary>
+    private static void WriteTar(Stream output)
+    {
+        var header = new byte[512];
+        foreach (var (name, file) in CorpusFiles())
+        {
+            var data = File.ReadAllBytes(file);
+            Array.Clear(header);
+            Encoding.ASCII.GetBytes(name, header.AsSpan(0, 100));
+            Octal(header, 100, 8, 0x1a4);
+            Octal(header, 108, 8, 0);
+            Octal(header, 116, 8, 0);
+            Octal(header, 124, 12, data.Length);
+            Octal(header, 136, 12, 1_600_000_000);
+            header[156] = (byte)'0';
+            Encoding.ASCII.GetBytes("ustar\0" + "00", header.AsSpan(257, 8));
+            header.AsSpan(148, 8).Fill((byte)' ');
+            Octal(header, 148, 7, header.Sum(b => (long)b));
+            output.Write(header);
+            output.Write(data);
+            output.Write(new byte[(512 - data.Length % 512) % 512]);
+        }
+        output.Write(new byte[1024]);
+    }
+
+    private static void Octal(byte[] header, int offset, int length, long value)
+    {
+        var digits = Convert.ToString(value, 8).PadLeft(length - 1, '0');
+        Encoding.ASCII.GetBytes(digits, header.AsSpan(offset, length - 1));
+        header[offset + length - 1] = 0;
+    }
+}
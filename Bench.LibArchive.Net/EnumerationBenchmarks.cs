@@ -0,0 +1,49 @@
+using BenchmarkDotNet.Attributes;
+using LibArchive.Net;
+
+namespace Bench.LibArchive.Net;
+
+/// <summary>
+/// Per-entry overhead on an archive of many tiny files: Entries(), which allocates an Entry, name and
+/// stream per header, against ReuseEntries(), whose Allocated column should stay at the cost of
+/// opening the reader however many entries there are
+/// </summary>
+[Config(typeof(BenchConfig))]
+public class EnumerationBenchmarks
+{
+    private readonly byte[] buffer = new byte[256];
+    private byte[] archive = null!;
+
+    [Params(10_000, 100_000)]
+    public int Entries { get; set; }
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        using var ms = new MemoryStream();
+        using (var writer = new LibArchiveWriter(ms, ArchiveFormat.Tar, leaveOpen: true))
+            for (var i = 0; i < Entries; i++)
+                writer.AddFile($"dir{i % 100}/file{i}", new byte[i % 200]);
+        archive = ms.ToArray();
+    }
+
+    [Benchmark(Baseline = true)]
+    public long Allocating()
+    {
+        long total = 0;
+        using var lar = new LibArchiveReader(archive);
+        foreach (var e in lar.Entries())
+            total += e.Name.Length + e.Stream.Read(buffer);
+        return total;
+    }
+
+    [Benchmark]
+    public long Reused()
+    {
+        long total = 0;
+        using var lar = new LibArchiveReader(archive);
+        foreach (var e in lar.ReuseEntries())
+            total += e.PathUtf8.Length + e.Stream.Read(buffer);
+        return total;
+    }
+}
@@ -0,0 +1,57 @@
+using BenchmarkDotNet.Attributes;
+using LibArchive.Net;
+
+namespace Bench.LibArchive.Net;
+
+/// <summary>
+/// Extraction to disk: libarchive's native disk writer, with and without preallocation, against
+/// copying each Entry.Stream into a managed FileStream. Extracts under the temp directory, so
+/// results depend on the filesystem behind it.
+/// </summary>
+[Config(typeof(BenchConfig))]
+public class ExtractBenchmarks
+{
+    private readonly string target = Path.Combine(Path.GetTempPath(), $"libarchive-net-extract-{Environment.ProcessId}");
+
+    [ParamsSource(nameof(Inputs))]
+    public BenchInput Input { get; set; } = null!;
+
+    public static IEnumerable<BenchInput> Inputs() => Corpus.All().Where(i => i.Name is "tar" or "tar.zst");
+
+    [IterationSetup]
+    public void Clean()
+    {
+        if (Directory.Exists(target))
+            Directory.Delete(target, true);
+    }
+
+    [GlobalCleanup]
+    public void Cleanup() => Clean();
+
+    [Benchmark(Baseline = true)]
+    public void ManagedCopy()
+    {
+        using var lar = new LibArchiveReader(Input.Path);
+        foreach (var e in lar.Entries())
+        {
+            var path = Path.Combine(target, e.Name);
+            Directory.CreateDirectory(Path.GetDirectoryName(path)!);
+            using var output = new FileStream(path, new FileStreamOptions { Mode = FileMode.Create, Access = FileAccess.Write, BufferSize = 0 });
+            e.Stream.CopyTo(output);
+        }
+    }
+
+    [Benchmark]
+    public void Native()
+    {
+        using var lar = new LibArchiveReader(Input.Path);
+        lar.ExtractTo(target);
+    }
+
+    [Benchmark]
+    public void NativePreallocated()
+    {
+        using var lar = new LibArchiveReader(Input.Path);
+        lar.ExtractTo(target, new ExtractOptions { Preallocate = true });
+    }
+}
@@ -0,0 +1,50 @@
+using BenchmarkDotNet.Attributes;
+using LibArchive.Net;
+
+namespace Bench.LibArchive.Net;
+
+/// <summary>
+/// Sequential extraction, header-only listing and List() across every corpus format
+/// </summary>
+[Config(typeof(BenchConfig))]
+public class FormatBenchmarks
+{
+    private readonly byte[] buffer = new byte[1 << 16];
+
+    [ParamsSource(nameof(Inputs))]
+    public BenchInput Input { get; set; } = null!;
+
+    public static IEnumerable<BenchInput> Inputs() => Corpus.All();
+
+    [Benchmark(Baseline = true)]
+    public long FullRead()
+    {
+        long total = 0;
+        using var lar = new LibArchiveReader(Input.Path);
+        foreach (var e in lar.Entries())
+        {
+            using var s = e.Stream;
+            int r;
+            while ((r = s.Read(buffer.AsSpan())) > 0)
+                total += r;
+        }
+        return total;
+    }
+
+    [Benchmark]
+    public int HeadersOnly()
+    {
+        var count = 0;
+        using var lar = new LibArchiveReader(Input.Path);
+        foreach (var _ in lar.Entries())
+            count++;
+        return count;
+    }
+
+    [Benchmark]
+    public int List()
+    {
+        using var lar = new LibArchiveReader(Input.Path);
+        return lar.List().Length;
+    }
+}
@@ -0,0 +1,52 @@
+using BenchmarkDotNet.Attributes;
+using LibArchive.Net;
+
+namespace Bench.LibArchive.Net;
+
+/// <summary>
+/// Reading the last file of an archive: a scan of Entries() against OpenEntry through a prebuilt index
+/// </summary>
+[Config(typeof(BenchConfig))]
+public class LookupBenchmarks
+{
+    private readonly byte[] buffer = new byte[1 << 16];
+    private LibArchiveReader indexed = null!;
+    private string last = null!;
+
+    [ParamsSource(nameof(Inputs))]
+    public BenchInput Input { get; set; } = null!;
+
+    public static IEnumerable<BenchInput> Inputs() => Corpus.All().Where(i => i.Name is "tar" or "zip" or "tar.zst");
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        indexed = new LibArchiveReader(Input.Path, 1 << 16);
+        last = indexed.Index.Names.Last();
+    }
+
+    [GlobalCleanup]
+    public void Cleanup() => indexed.Dispose();
+
+    [Benchmark(Baseline = true)]
+    public long Scan()
+    {
+        using var lar = new LibArchiveReader(Input.Path, 1 << 16);
+        foreach (var e in lar.Entries())
+            if (e.Name == last)
+                return Drain(e.Stream);
+        return -1;
+    }
+
+    [Benchmark]
+    public long OpenEntry() => Drain(indexed.OpenEntry(last)!.Stream);
+
+    private long Drain(Stream s)
+    {
+        long total = 0;
+        int r;
+        while ((r = s.Read(buffer)) > 0)
+            total += r;
+        return total;
+    }
+}
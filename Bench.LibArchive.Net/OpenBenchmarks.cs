@@ -0,0 +1,71 @@
+using BenchmarkDotNet.Attributes;
+using LibArchive.Net;
+
+namespace Bench.LibArchive.Net;
+
+/// <summary>
+/// Cost of creating a reader and detecting the format, on a tiny tar, with every format and filter
+/// registered against only the ones needed, and through a LibArchiveReaderPool
+/// </summary>
+[Config(typeof(BenchConfig))]
+public class OpenBenchmarks
+{
+    private static readonly ReaderOptions TarOnly = new() { Formats = ReadFormats.Tar, Filters = ReadFilters.None };
+
+    private byte[] tar = null!;
+    private LibArchiveReaderPool pool = null!;
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        using var ms = new MemoryStream();
+        using (var writer = new LibArchiveWriter(ms, ArchiveFormat.Ustar, leaveOpen: true))
+        {
+            writer.AddFile("small.txt", new byte[100]);
+            writer.Finish();
+        }
+        tar = ms.ToArray();
+        pool = new LibArchiveReaderPool(TarOnly, 64 << 10);
+    }
+
+    [GlobalCleanup]
+    public void Cleanup()
+    {
+        pool.Dispose();
+    }
+
+    [Benchmark(Baseline = true)]
+    public int AllFormats()
+    {
+        using var lar = new LibArchiveReader(tar);
+        return lar.List().Length;
+    }
+
+    [Benchmark]
+    public int TarOnlyFormat()
+    {
+        using var lar = new LibArchiveReader(tar, TarOnly);
+        return lar.List().Length;
+    }
+
+    [Benchmark]
+    public int TarOnlyPooled()
+    {
+        using var lar = pool.Open(tar);
+        return lar.List().Length;
+    }
+
+    [Benchmark]
+    public int TarOnlyStream()
+    {
+        using var lar = new LibArchiveReader(new MemoryStream(tar), 64 << 10, options: TarOnly);
+        return lar.List().Length;
+    }
+
+    [Benchmark]
+    public int TarOnlyStreamPooled()
+    {
+        using var lar = pool.Open(new MemoryStream(tar));
+        return lar.List().Length;
+    }
+}
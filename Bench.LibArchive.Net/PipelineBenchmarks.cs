@@ -0,0 +1,56 @@
+using System.Security.Cryptography;
+using BenchmarkDotNet.Attributes;
+using LibArchive.Net;
+
+namespace Bench.LibArchive.Net;
+
+/// <summary>
+/// SHA-256 of every entry, hashing in lock-step with decompression against hashing chunks from
+/// ReadPipelined while the next ones are decompressed on another core
+/// </summary>
+[Config(typeof(BenchConfig))]
+public class PipelineBenchmarks
+{
+    private readonly byte[] buffer = new byte[1 << 20];
+
+    [ParamsSource(nameof(Inputs))]
+    public BenchInput Input { get; set; } = null!;
+
+    public static IEnumerable<BenchInput> Inputs() => Corpus.All().Where(i => i.Name is "tar.xz" or "tar.zst" or "7z");
+
+    [Benchmark(Baseline = true)]
+    public int Sequential()
+    {
+        using var hash = IncrementalHash.CreateHash(HashAlgorithmName.SHA256);
+        using var lar = new LibArchiveReader(Input.Path);
+        var count = 0;
+        foreach (var e in lar.Entries())
+        {
+            using var s = e.Stream;
+            int r;
+            while ((r = s.Read(buffer.AsSpan())) > 0)
+                hash.AppendData(buffer.AsSpan(0, r));
+            hash.GetHashAndReset();
+            count++;
+        }
+        return count;
+    }
+
+    [Benchmark]
+    public async Task<int> Pipelined()
+    {
+        using var hash = IncrementalHash.CreateHash(HashAlgorithmName.SHA256);
+        using var lar = new LibArchiveReader(Input.Path);
+        var count = 0;
+        await foreach (var chunk in lar.ReadPipelined().ReadAllAsync())
+        {
+            hash.AppendData(chunk.Data.Span);
+            if (chunk.IsLast)
+            {
+                hash.GetHashAndReset();
+                count++;
+            }
+        }
+        return count;
+    }
+}
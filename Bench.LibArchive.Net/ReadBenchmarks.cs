@@ -0,0 +1,119 @@
+using BenchmarkDotNet.Attributes;
+using LibArchive.Net;
+
+namespace Bench.LibArchive.Net;
+
+/// <summary>
+/// Compare the Span/CopyTo overrides on LibArchiveReader.FileStream against the
+/// base Stream fallback (rent a temporary array, read into it, copy out)
+/// </summary>
+[MemoryDiagnoser]
+public class ReadBenchmarks
+{
+    private const string Archive = "7ztest.7z";
+    private readonly byte[] buffer = new byte[1 << 16];
+
+    [Benchmark(Baseline = true)]
+    public long SpanViaBaseFallback()
+    {
+        long total = 0;
+        using var lar = new LibArchiveReader(Archive);
+        foreach (var e in lar.Entries())
+        {
+            using var s = new ArrayOnlyStream(e.Stream);
+            int r;
+            while ((r = s.Read(buffer.AsSpan())) > 0)
+                total += r;
+        }
+        return total;
+    }
+
+    [Benchmark]
+    public long SpanDirect()
+    {
+        long total = 0;
+        using var lar = new LibArchiveReader(Archive);
+        foreach (var e in lar.Entries())
+        {
+            using var s = e.Stream;
+            int r;
+            while ((r = s.Read(buffer.AsSpan())) > 0)
+                total += r;
+        }
+        return total;
+    }
+
+    [Benchmark]
+    public long CopyToNull()
+    {
+        using var lar = new LibArchiveReader(Archive);
+        foreach (var e in lar.Entries())
+        {
+            using var s = e.Stream;
+            s.CopyTo(Stream.Null, buffer.Length);
+        }
+        return 0;
+    }
+
+    [Benchmark]
+    public long BlocksNoCopy()
+    {
+        long total = 0;
+        using var lar = new LibArchiveReader(Archive);
+        foreach (var e in lar.Entries())
+        foreach (var block in e.ReadBlocks())
+            total += block.Data.Length;
+        return total;
+    }
+
+    /// <summary>
+    /// Whole files of the generated tar corpus into arrays: a growing MemoryStream against one
+    /// allocation of the size from the header
+    /// </summary>
+    [Benchmark]
+    public long MemoryStreamPerFile()
+    {
+        long total = 0;
+        using var lar = new LibArchiveReader(Corpus.Get("tar").Path);
+        foreach (var e in lar.Entries())
+        {
+            using var ms = new MemoryStream();
+            e.Stream.CopyTo(ms);
+            total += ms.ToArray().Length;
+        }
+        return total;
+    }
+
+    [Benchmark]
+    public long ReadAllBytesPerFile()
+    {
+        long total = 0;
+        using var lar = new LibArchiveReader(Corpus.Get("tar").Path);
+        foreach (var e in lar.Entries())
+            total += e.ReadAllBytes().Length;
+        return total;
+    }
+
+    /// <summary>
+    /// Wrapper exposing only Read(byte[],int,int), as FileStream did before the Span overrides
+    /// </summary>
+    private sealed class ArrayOnlyStream : Stream
+    {
+        private readonly Stream inner;
+        public ArrayOnlyStream(Stream inner) => this.inner = inner;
+        public override int Read(byte[] buffer, int offset, int count) => inner.Read(buffer, offset, count);
+        public override void Flush() { }
+        public override long Seek(long offset, SeekOrigin origin) => throw new NotSupportedException();
+        public override void SetLength(long value) => throw new NotSupportedException();
+        public override void Write(byte[] buffer, int offset, int count) => throw new NotSupportedException();
+        public override bool CanRead => true;
+        public override bool CanSeek => false;
+        public override bool CanWrite => false;
+        public override long Length => throw new NotSupportedException();
+        public override long Position
+        {
+            get => throw new NotSupportedException();
+            set => throw new NotSupportedException();
+        }
+    }
+}
@@ -0,0 +1,34 @@
+using BenchmarkDotNet.Columns;
+using BenchmarkDotNet.Reports;
+using BenchmarkDotNet.Running;
+
+namespace Bench.LibArchive.Net;
+
+/// <summary>
+/// Uncompressed MB/s for benchmarks with an Input parameter, from the mean time per operation
+/// </summary>
+public sealed class ThroughputColumn : IColumn
+{
+    public string Id => nameof(ThroughputColumn);
+    public string ColumnName => "MB/s";
+    public bool AlwaysShow => true;
+    public ColumnCategory Category => ColumnCategory.Custom;
+    public int PriorityInCategory => 0;
+    public bool IsNumeric => true;
+    public UnitType UnitType => UnitType.Dimensionless;
+    public string Legend => "Uncompressed megabytes (2^20 bytes) produced per second";
+
+    public string GetValue(Summary summary, BenchmarkCase benchmarkCase) => GetValue(summary, benchmarkCase, SummaryStyle.Default);
+
+    public string GetValue(Summary summary, BenchmarkCase benchmarkCase, SummaryStyle style)
+    {
+        var mean = summary[benchmarkCase]?.ResultStatistics?.Mean;
+        if (mean is null || benchmarkCase.Parameters["Input"] is not BenchInput input)
+            return "-";
+        return (Corpus.UncompressedBytes(input) / (double)(1 << 20) / (mean.Value / 1e9)).ToString("N1");
+    }
+
+    public bool IsDefault(Summary summary, BenchmarkCase benchmarkCase) => false;
+
+    public bool IsAvailable(Summary summary) => true;
+}
@@ -0,0 +1,45 @@
+using BenchmarkDotNet.Attributes;
+using LibArchive.Net;
+
+namespace Bench.LibArchive.Net;
+
+/// <summary>
+/// Effect of the reader's blockSize and of the buffer size passed to FileStream.Read
+/// </summary>
+[Config(typeof(BenchConfig))]
+public class TuningBenchmarks
+{
+    private byte[] buffer = null!;
+
+    [ParamsSource(nameof(Inputs))]
+    public BenchInput Input { get; set; } = null!;
+
+    [Params(16u << 10, 64u << 10, 1u << 20, 4u << 20)]
+    public uint BlockSize { get; set; }
+
+    [Params(4 << 10, 64 << 10, 1 << 20)]
+    public int BufferSize { get; set; }
+
+    public static IEnumerable<BenchInput> Inputs() => Corpus.All().Where(i => i.Name is "tar" or "tar.gz" or "zip");
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        buffer = new byte[BufferSize];
+    }
+
+    [Benchmark]
+    public long Read()
+    {
+        long total = 0;
+        using var lar = new LibArchiveReader(Input.Path, BlockSize);
+        foreach (var e in lar.Entries())
+        {
+            using var s = e.Stream;
+            int r;
+            while ((r = s.Read(buffer.AsSpan())) > 0)
+                total += r;
+        }
+        return total;
+    }
+}
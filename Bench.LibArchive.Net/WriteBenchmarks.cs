@@ -0,0 +1,42 @@
+using BenchmarkDotNet.Attributes;
+using LibArchive.Net;
+
+namespace Bench.LibArchive.Net;
+
+/// <summary>
+/// LibArchiveWriter packing the in-memory corpus with the multi-threaded filters, by thread count
+/// (0 meaning one per core).
+/// Input is always the plain tar, so MB/s is uncompressed corpus bytes written per second.
+/// </summary>
+[Config(typeof(BenchConfig))]
+public class WriteBenchmarks
+{
+    private (string Name, byte[] Data)[] files = null!;
+
+    [ParamsSource(nameof(Inputs))]
+    public BenchInput Input { get; set; } = null!;
+
+    [Params(ArchiveFilter.Zstd, ArchiveFilter.Xz)]
+    public ArchiveFilter Filter { get; set; }
+
+    [Params(1, 4, 0)]
+    public int Threads { get; set; }
+
+    public static IEnumerable<BenchInput> Inputs() => Corpus.All().Where(i => i.Name is "tar");
+
+    [GlobalSetup]
+    public void Setup()
+    {
+        files = Corpus.SourceFiles().Select(f => (f.Name, File.ReadAllBytes(f.Path))).ToArray();
+    }
+
+    [Benchmark]
+    public void Write()
+    {
+        var threads = Threads == 0 ? Environment.ProcessorCount : Threads;
+        using var writer = new LibArchiveWriter(Stream.Null, ArchiveFormat.Tar, Filter, threads: threads);
+        foreach (var (name, data) in files)
+            writer.AddFile(name, data);
+        writer.Finish();
+    }
+}
@@ -0,0 +1,32 @@
+using System;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// One buffer of decompressed entry data from LibArchiveReader.ReadPipelined. Data is only valid
+/// until the next read from the channel.
+/// </summary>
+public readonly struct ArchiveChunk
+{
+    /// <summary>
+    /// Ordinal of the entry within the archive, counting every header read
+    /// </summary>
+    public int EntryIndex { get; }
+
+    public ArchiveEntryInfo Entry { get; }
+
+    public ReadOnlyMemory<byte> Data { get; }
+
+    /// <summary>
+    /// Whether this is the entry's final chunk; Data may then be empty
+    /// </summary>
+    public bool IsLast { get; }
+
+    internal ArchiveChunk(int entryIndex, ArchiveEntryInfo entry, ReadOnlyMemory<byte> data, bool isLast)
+    {
+        EntryIndex = entryIndex;
+        Entry = entry;
+        Data = data;
+        IsLast = isLast;
+    }
+}
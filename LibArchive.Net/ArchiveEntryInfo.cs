@@ -0,0 +1,45 @@
+using System;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// Header metadata for one entry, as returned by LibArchiveReader.List()
+/// </summary>
+public readonly struct ArchiveEntryInfo
+{
+    public string Name { get; }
+
+    /// <summary>
+    /// Uncompressed size in bytes, or -1 if the header does not record it
+    /// </summary>
+    public long Size { get; }
+
+    /// <summary>
+    /// Modification time, or null if the header does not record it
+    /// </summary>
+    public DateTimeOffset? LastModified { get; }
+
+    public EntryType Type { get; }
+
+    /// <summary>
+    /// Permission bits (the low 12 bits of the Unix mode)
+    /// </summary>
+    public int Permissions { get; }
+
+    public string? HardlinkTarget { get; }
+    public string? SymlinkTarget { get; }
+
+    internal ArchiveEntryInfo(string name, long size, DateTimeOffset? lastModified, EntryType type, int permissions,
+        string? hardlinkTarget, string? symlinkTarget)
+    {
+        Name = name;
+        Size = size;
+        LastModified = lastModified;
+        Type = type;
+        Permissions = permissions;
+        HardlinkTarget = hardlinkTarget;
+        SymlinkTarget = symlinkTarget;
+    }
+
+    public override string ToString() => Name;
+}
@@ -0,0 +1,38 @@
+using System;
+using System.Runtime.InteropServices;
+using static LibArchive.Net.Native;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// A failure reported by libarchive, with its status code and errno. Derives from
+/// ApplicationException, which the library threw before, so existing handlers still catch it.
+/// </summary>
+public class ArchiveException : ApplicationException
+{
+    public ArchiveException(string message, ArchiveResult result = ArchiveResult.Fatal, int errorNumber = 0) : base(message)
+    {
+        Result = result;
+        ErrorNumber = errorNumber;
+    }
+
+    /// <summary>
+    /// What libarchive returned: Failed if only the current entry is affected, Fatal if the archive is unusable
+    /// </summary>
+    public ArchiveResult Result { get; }
+
+    /// <summary>
+    /// archive_errno: an errno value such as ENOENT, or libarchive's ARCHIVE_ERRNO_FILE_FORMAT (84),
+    /// ARCHIVE_ERRNO_PROGRAMMER (22) or ARCHIVE_ERRNO_MISC (-1); 0 if none was set
+    /// </summary>
+    public int ErrorNumber { get; }
+
+    /// <summary>
+    /// The error libarchive recorded against archive, a reader, writer or match handle
+    /// </summary>
+    internal static ArchiveException From(IntPtr archive, int result, string fallback)
+    {
+        var message = Marshal.PtrToStringUTF8(archive_error_string(archive));
+        return new ArchiveException(string.IsNullOrEmpty(message) ? fallback : message, (ArchiveResult)result, archive_errno(archive));
+    }
+}
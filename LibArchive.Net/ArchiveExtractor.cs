@@ -0,0 +1,194 @@
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.IO;
+using System.Runtime.ExceptionServices;
+using System.Security.Cryptography;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// Process or extract the entries of one archive file concurrently, using several independent
+/// LibArchiveReader handles on the same file. Each handle is given a contiguous run of entries,
+/// balanced by size, so solid 7z blocks are mostly decoded by a single handle.
+/// Formats which cannot skip to an entry without decoding everything before it (tar, compressed
+/// streams, solid rar) are processed on a single handle instead.
+/// </summary>
+public sealed class ArchiveExtractor
+{
+    private readonly string _filename;
+    private readonly uint _blockSize;
+    private readonly bool _memoryMapped;
+    private readonly ReaderOptions? _options;
+
+    public int MaxDegreeOfParallelism { get; }
+
+    /// <summary>
+    /// Prepare to process the named archive
+    /// </summary>
+    /// <param name="filename"></param>
+    /// <param name="maxDegreeOfParallelism">Maximum number of concurrent handles, default one per core</param>
+    /// <param name="blockSize">Block size in bytes, default 1 MiB</param>
+    /// <param name="memoryMapped">Map the archive once per handle with OpenMapped, sharing page cache pages between handles</param>
+    /// <param name="options">Formats, filters and options for every handle</param>
+    public ArchiveExtractor(string filename, int maxDegreeOfParallelism = 0, uint blockSize = 1<<20, bool memoryMapped = false, ReaderOptions? options = null)
+    {
+        if (maxDegreeOfParallelism < 0)
+            throw new ArgumentOutOfRangeException(nameof(maxDegreeOfParallelism));
+        _filename = filename ?? throw new ArgumentNullException(nameof(filename));
+        _blockSize = blockSize;
+        _memoryMapped = memoryMapped;
+        _options = options;
+        MaxDegreeOfParallelism = maxDegreeOfParallelism == 0 ? Environment.ProcessorCount : maxDegreeOfParallelism;
+    }
+
+    private LibArchiveReader Open() => _memoryMapped ? LibArchiveReader.OpenMapped(_filename, _options) : new LibArchiveReader(_filename, _blockSize, _options);
+
+    /// <summary>
+    /// Invoke action for every entry. Calls are made concurrently from several threads, each on the
+    /// thread owning the entry's handle; the entry and its Stream are only valid until action returns.
+    /// </summary>
+    /// <param name="action"></param>
+    /// <param name="cancellationToken"></param>
+    public void Process(Action<LibArchiveReader.Entry> action, CancellationToken cancellationToken = default)
+    {
+        if (action is null)
+            throw new ArgumentNullException(nameof(action));
+        Process((e, _) => action(e), cancellationToken);
+    }
+
+    /// <summary>
+    /// Process, also giving action each entry's position in the archive
+    /// </summary>
+    private void Process(Action<LibArchiveReader.Entry, int> action, CancellationToken cancellationToken)
+    {
+        var sizes = new List<long>();
+        bool randomAccess;
+        using (var scan = Open())
+        {
+            foreach (var e in scan.Entries())
+                sizes.Add(Math.Max(e.Size, 0));
+            randomAccess = sizes.Count > 0 && scan.IsRandomAccess;
+        }
+
+        var partitions = randomAccess ? Partition(sizes, MaxDegreeOfParallelism) : new[] { 0, sizes.Count };
+        var options = new ParallelOptions
+        {
+            MaxDegreeOfParallelism = MaxDegreeOfParallelism,
+            CancellationToken = cancellationToken
+        };
+        try
+        {
+            Parallel.For(0, partitions.Length - 1, options, p => ProcessRange(partitions[p], partitions[p + 1], action, cancellationToken));
+        }
+        catch (AggregateException e) when (e.InnerExceptions.Count == 1)
+        {
+            ExceptionDispatchInfo.Capture(e.InnerException!).Throw();
+        }
+    }
+
+    private void ProcessRange(int start, int end, Action<LibArchiveReader.Entry, int> action, CancellationToken cancellationToken)
+    {
+        using var reader = Open();
+        var index = 0;
+        foreach (var e in reader.Entries())
+        {
+            if (index >= end)
+                break;
+            if (index++ < start)
+                continue;
+            cancellationToken.ThrowIfCancellationRequested();
+            action(e, index - 1);
+        }
+    }
+
+    /// <summary>
+    /// Extract regular files and directories under directory, concurrently. Entries whose paths would
+    /// land outside directory are rejected; other entry types (links, devices) are skipped.
+    /// </summary>
+    /// <param name="directory"></param>
+    /// <param name="cancellationToken"></param>
+    /// <exception cref="IOException"></exception>
+    public void ExtractTo(string directory, CancellationToken cancellationToken = default)
+    {
+        var root = Path.GetFullPath(directory);
+        if (!Path.EndsInDirectorySeparator(root))
+            root += Path.DirectorySeparatorChar;
+        Directory.CreateDirectory(root);
+
+        Process(e =>
+        {
+            var target = Path.GetFullPath(Path.Combine(root, e.Name));
+            if (!target.StartsWith(root, StringComparison.Ordinal) && target + Path.DirectorySeparatorChar != root)
+                throw new IOException($"Entry '{e.Name}' would be extracted outside '{directory}'");
+            switch (e.Type)
+            {
+                case EntryType.Directory:
+                    Directory.CreateDirectory(target);
+                    break;
+                case EntryType.File:
+                    Directory.CreateDirectory(Path.GetDirectoryName(target)!);
+                    using (var output = new System.IO.FileStream(target, new FileStreamOptions
+                           {
+                               Mode = FileMode.Create,
+                               Access = FileAccess.Write,
+                               BufferSize = 0,
+                               PreallocationSize = Math.Max(e.Size, 0)
+                           }))
+                        e.Stream.CopyTo(output);
+                    break;
+            }
+        }, cancellationToken);
+    }
+
+    /// <summary>
+    /// Hash every regular file concurrently, each on the handle decompressing it, straight from
+    /// libarchive's blocks (see Entry.ComputeHash)
+    /// </summary>
+    /// <param name="algorithm">e.g. HashAlgorithmName.SHA256</param>
+    /// <param name="cancellationToken"></param>
+    /// <returns>Each file's hash by path; the last if a path appears more than once</returns>
+    public Dictionary<string, byte[]> ComputeHashes(HashAlgorithmName algorithm, CancellationToken cancellationToken = default)
+    {
+        var hashes = new ConcurrentDictionary<string, (int Ordinal, byte[] Hash)>();
+        Process((e, ordinal) =>
+        {
+            if (e.Type != EntryType.File)
+                return;
+            (int Ordinal, byte[] Hash) hash = (ordinal, e.ComputeHash(algorithm));
+            hashes.AddOrUpdate(e.Name, hash, (_, other) => other.Ordinal > hash.Ordinal ? other : hash);
+        }, cancellationToken);
+        var result = new Dictionary<string, byte[]>(hashes.Count);
+        foreach (var (name, (_, hash)) in hashes)
+            result[name] = hash;
+        return result;
+    }
+
+    /// <summary>
+    /// Split entries into at most count contiguous runs of roughly equal total size. Every entry
+    /// also carries a nominal cost so that runs of empty entries still get spread out.
+    /// </summary>
+    /// <returns>Run boundaries: run i covers entries [result[i], result[i+1])</returns>
+    private static int[] Partition(List<long> sizes, int count)
+    {
+        const long perEntry = 4096;
+        count = Math.Max(1, Math.Min(count, sizes.Count));
+        long total = 0;
+        foreach (var size in sizes)
+            total += size + perEntry;
+
+        var bounds = new List<int> { 0 };
+        long running = 0;
+        for (var i = 0; i < sizes.Count && bounds.Count < count; i++)
+        {
+            running += sizes[i] + perEntry;
+            if (running >= total * bounds.Count / count)
+                bounds.Add(i + 1);
+        }
+        if (bounds[^1] != sizes.Count)
+            bounds.Add(sizes.Count);
+        return bounds.ToArray();
+    }
+}
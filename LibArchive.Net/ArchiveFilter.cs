@@ -0,0 +1,18 @@
+namespace LibArchive.Net;
+
+/// <summary>
+/// Compression filters LibArchiveWriter can apply over the whole archive
+/// </summary>
+public enum ArchiveFilter
+{
+    None,
+    Gzip,
+    Bzip2,
+    Xz,
+    Lzma,
+    Lzip,
+    Zstd,
+    Lz4,
+    Lzop,
+    Compress
+}
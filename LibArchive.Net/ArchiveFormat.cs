@@ -0,0 +1,20 @@
+namespace LibArchive.Net;
+
+/// <summary>
+/// Container formats LibArchiveWriter can produce
+/// </summary>
+public enum ArchiveFormat
+{
+    /// <summary>
+    /// POSIX pax tar, only adding pax extension headers where ustar cannot represent an entry
+    /// </summary>
+    Tar,
+    Pax,
+    Ustar,
+    GnuTar,
+    Cpio,
+    Zip,
+    SevenZip,
+    Iso9660,
+    Xar
+}
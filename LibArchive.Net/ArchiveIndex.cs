@@ -0,0 +1,276 @@
+using System;
+using System.Buffers.Binary;
+using System.Collections.Generic;
+using System.IO;
+using System.Text;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// Where each entry of an archive file starts, so LibArchiveReader.OpenEntry can go straight to
+/// one entry instead of reading every header before it. For unfiltered tar and cpio archives the
+/// offset of each header comes from the scan itself; zip offsets come from the central directory,
+/// as libarchive's seekable zip reader does not report them. Other formats, and compressed archives,
+/// only record each entry's position in header order. Immutable, so one index can be shared by
+/// readers on any number of threads, and saved to a sidecar file for later processes.
+/// </summary>
+public sealed class ArchiveIndex
+{
+    private const int FORMAT_CPIO = 0x10000;
+    private const int FORMAT_TAR = 0x30000;
+    private const int FORMAT_ZIP = 0x50000;
+    private static readonly byte[] Magic = Encoding.ASCII.GetBytes("LAIX");
+    private const int Version = 1;
+
+    private readonly Dictionary<string, (int Ordinal, long Offset)> _entries;
+    private readonly long _length;
+    private readonly long _lastWriteTicks;
+
+    private ArchiveIndex(Dictionary<string, (int, long)> entries, long length, long lastWriteTicks, int format, bool seeks)
+    {
+        _entries = entries;
+        _length = length;
+        _lastWriteTicks = lastWriteTicks;
+        Format = format;
+        SeeksToEntries = seeks;
+    }
+
+    /// <summary>
+    /// libarchive's base format code, e.g. 0x50000 for zip
+    /// </summary>
+    internal int Format { get; }
+
+    /// <summary>
+    /// Whether entries are opened by seeking to their header; otherwise OpenEntry reads the headers
+    /// before the entry, skipping their data
+    /// </summary>
+    public bool SeeksToEntries { get; }
+
+    public int Count => _entries.Count;
+
+    public IEnumerable<string> Names => _entries.Keys;
+
+    public bool Contains(string name) => _entries.ContainsKey(name);
+
+    internal bool TryGetLocation(string name, out int ordinal, out long offset)
+    {
+        var found = _entries.TryGetValue(name, out var location);
+        (ordinal, offset) = location;
+        return found;
+    }
+
+    /// <summary>
+    /// Whether filename still has the length and modification time it had when the index was built
+    /// </summary>
+    /// <param name="filename"></param>
+    public bool IsCurrent(string filename)
+    {
+        var info = new FileInfo(filename);
+        return info.Exists && info.Length == _length && info.LastWriteTimeUtc.Ticks == _lastWriteTicks;
+    }
+
+    /// <summary>
+    /// Scan the headers of the named archive, skipping all entry data
+    /// </summary>
+    /// <param name="filename"></param>
+    /// <param name="options">Formats, filters and options to use, default all formats and filters</param>
+    /// <exception cref="ArchiveException"></exception>
+    public static ArchiveIndex Build(string filename, ReaderOptions? options = null)
+    {
+        var info = new FileInfo(filename);
+        var length = info.Length;
+        var lastWrite = info.LastWriteTimeUtc.Ticks;
+        List<(string? Name, long Position)> headers;
+        int format;
+        bool filtered;
+        using (var reader = new LibArchiveReader(filename, options: options))
+            headers = reader.ScanHeaders(out format, out filtered);
+
+        var offsets = filtered ? null : format switch
+        {
+            FORMAT_TAR or FORMAT_CPIO => headers.ConvertAll(h => h.Position),
+            FORMAT_ZIP => ZipOffsets(filename, headers.Count),
+            _ => null
+        };
+        var entries = new Dictionary<string, (int, long)>(headers.Count);
+        for (var i = 0; i < headers.Count; i++)
+            if (headers[i].Name is { } name)
+                entries[name] = (i, offsets?[i] ?? -1);
+        return new ArchiveIndex(entries, length, lastWrite, format, offsets is not null);
+    }
+
+    /// <summary>
+    /// Load a saved index for filename from sidecar if it is still current, otherwise build a new
+    /// one and save it there
+    /// </summary>
+    /// <param name="filename"></param>
+    /// <param name="sidecar">Index file, default filename + ".index"</param>
+    /// <param name="options">Formats, filters and options used to build the index</param>
+    /// <exception cref="ArchiveException"></exception>
+    public static ArchiveIndex LoadOrBuild(string filename, string? sidecar = null, ReaderOptions? options = null)
+    {
+        sidecar ??= filename + ".index";
+        if (File.Exists(sidecar))
+        {
+            try
+            {
+                var saved = Load(sidecar);
+                if (saved.IsCurrent(filename))
+                    return saved;
+            }
+            catch (Exception e) when (e is InvalidDataException or EndOfStreamException)
+            {
+                // Rebuilt below
+            }
+        }
+
+        var index = Build(filename, options);
+        // Write aside and rename, so concurrent processes never load a partly written index
+        var temp = $"{sidecar}.{Guid.NewGuid():N}.tmp";
+        try
+        {
+            index.Save(temp);
+            File.Move(temp, sidecar, true);
+        }
+        finally
+        {
+            File.Delete(temp);
+        }
+        return index;
+    }
+
+    /// <summary>
+    /// Read an index written by Save
+    /// </summary>
+    /// <param name="path"></param>
+    /// <exception cref="InvalidDataException">path does not hold an index</exception>
+    public static ArchiveIndex Load(string path)
+    {
+        using var reader = new BinaryReader(File.OpenRead(path), Encoding.UTF8);
+        if (!reader.ReadBytes(Magic.Length).AsSpan().SequenceEqual(Magic) || reader.ReadInt32() != Version)
+            throw new InvalidDataException($"{path} is not an archive index");
+        var length = reader.ReadInt64();
+        var lastWrite = reader.ReadInt64();
+        var format = reader.ReadInt32();
+        var seeks = reader.ReadBoolean();
+        var count = reader.ReadInt32();
+        // Each entry takes at least 13 bytes: a length-prefixed name, an ordinal and an offset
+        if (count < 0 || count > (reader.BaseStream.Length - reader.BaseStream.Position) / 13)
+            throw new InvalidDataException($"{path} is a damaged archive index");
+        var entries = new Dictionary<string, (int, long)>(count);
+        for (var i = 0; i < count; i++)
+            entries[reader.ReadString()] = (reader.ReadInt32(), reader.ReadInt64());
+        return new ArchiveIndex(entries, length, lastWrite, format, seeks);
+    }
+
+    /// <summary>
+    /// Write the index to path, replacing any existing file
+    /// </summary>
+    /// <param name="path"></param>
+    public void Save(string path)
+    {
+        using var writer = new BinaryWriter(File.Create(path), Encoding.UTF8);
+        writer.Write(Magic);
+        writer.Write(Version);
+        writer.Write(_length);
+        writer.Write(_lastWriteTicks);
+        writer.Write(Format);
+        writer.Write(SeeksToEntries);
+        writer.Write(_entries.Count);
+        foreach (var (name, (ordinal, offset)) in _entries)
+        {
+            writer.Write(name);
+            writer.Write(ordinal);
+            writer.Write(offset);
+        }
+    }
+
+    /// <summary>
+    /// Local header offsets from the zip central directory, in ascending order as libarchive's
+    /// seekable reader returns the entries; null if the directory is unreadable or does not list
+    /// exactly count entries
+    /// </summary>
+    private static List<long>? ZipOffsets(string filename, int count)
+    {
+        const uint EOCD = 0x06054b50, ZIP64_LOCATOR = 0x07064b50, ZIP64_EOCD = 0x06064b50, CENTRAL = 0x02014b50;
+        using var file = File.OpenHandle(filename);
+        var length = RandomAccess.GetLength(file);
+        var tail = new byte[(int)Math.Min(length, 22 + 0xFFFF + 20)];
+        if (RandomAccess.Read(file, tail, length - tail.Length) != tail.Length)
+            return null;
+        var eocd = tail.Length - 22;
+        while (eocd >= 0 && BinaryPrimitives.ReadUInt32LittleEndian(tail.AsSpan(eocd)) != EOCD)
+            eocd--;
+        if (eocd < 0)
+            return null;
+
+        try
+        {
+            long entries = BinaryPrimitives.ReadUInt16LittleEndian(tail.AsSpan(eocd + 10));
+            long size = BinaryPrimitives.ReadUInt32LittleEndian(tail.AsSpan(eocd + 12));
+            long start = BinaryPrimitives.ReadUInt32LittleEndian(tail.AsSpan(eocd + 16));
+            if ((entries == 0xFFFF || size == 0xFFFFFFFF || start == 0xFFFFFFFF) && eocd >= 20 &&
+                BinaryPrimitives.ReadUInt32LittleEndian(tail.AsSpan(eocd - 20)) == ZIP64_LOCATOR)
+            {
+                var zip64 = new byte[56];
+                RandomAccess.Read(file, zip64, BinaryPrimitives.ReadInt64LittleEndian(tail.AsSpan(eocd - 12)));
+                if (BinaryPrimitives.ReadUInt32LittleEndian(zip64) != ZIP64_EOCD)
+                    return null;
+                entries = BinaryPrimitives.ReadInt64LittleEndian(zip64.AsSpan(32));
+                size = BinaryPrimitives.ReadInt64LittleEndian(zip64.AsSpan(40));
+                start = BinaryPrimitives.ReadInt64LittleEndian(zip64.AsSpan(48));
+            }
+            if (entries != count || size > int.MaxValue || start < 0 || start + size > length)
+                return null;
+
+            var directory = new byte[size];
+            if (RandomAccess.Read(file, directory, start) != size)
+                return null;
+            var offsets = new List<long>(count);
+            var p = 0;
+            while (p + 46 <= directory.Length && BinaryPrimitives.ReadUInt32LittleEndian(directory.AsSpan(p)) == CENTRAL)
+            {
+                var header = directory.AsSpan(p);
+                int nameLength = BinaryPrimitives.ReadUInt16LittleEndian(header[28..]);
+                int extraLength = BinaryPrimitives.ReadUInt16LittleEndian(header[30..]);
+                int commentLength = BinaryPrimitives.ReadUInt16LittleEndian(header[32..]);
+                long offset = BinaryPrimitives.ReadUInt32LittleEndian(header[42..]);
+                if (offset == 0xFFFFFFFF)
+                    offset = Zip64Offset(header.Slice(46 + nameLength, extraLength),
+                        BinaryPrimitives.ReadUInt32LittleEndian(header[24..]) == 0xFFFFFFFF,
+                        BinaryPrimitives.ReadUInt32LittleEndian(header[20..]) == 0xFFFFFFFF);
+                if (offset < 0)
+                    return null;
+                offsets.Add(offset);
+                p += 46 + nameLength + extraLength + commentLength;
+            }
+            offsets.Sort();
+            return offsets.Count == count ? offsets : null;
+        }
+        catch (ArgumentOutOfRangeException)
+        {
+            // A field ran past the end of the directory
+            return null;
+        }
+    }
+
+    /// <summary>
+    /// The local header offset from a zip64 extra field, which holds only the sizes and offset whose
+    /// fixed fields overflowed, in that order
+    /// </summary>
+    private static long Zip64Offset(ReadOnlySpan<byte> extra, bool hasSize, bool hasCompressedSize)
+    {
+        while (extra.Length >= 4)
+        {
+            var id = BinaryPrimitives.ReadUInt16LittleEndian(extra);
+            var length = BinaryPrimitives.ReadUInt16LittleEndian(extra[2..]);
+            if (id == 1)
+            {
+                var at = 4 + (hasSize ? 8 : 0) + (hasCompressedSize ? 8 : 0);
+                return BinaryPrimitives.ReadInt64LittleEndian(extra[at..]);
+            }
+            extra = extra[Math.Min(extra.Length, 4 + length)..];
+        }
+        return -1;
+    }
+}
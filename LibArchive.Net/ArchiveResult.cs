@@ -0,0 +1,29 @@
+namespace LibArchive.Net;
+
+/// <summary>
+/// libarchive's ARCHIVE_* status codes
+/// </summary>
+public enum ArchiveResult
+{
+    Ok = 0,
+    /// <summary>
+    /// No more entries
+    /// </summary>
+    Eof = 1,
+    /// <summary>
+    /// Nothing was read, but trying again may succeed
+    /// </summary>
+    Retry = -10,
+    /// <summary>
+    /// The operation succeeded, but something about it deserves a mention
+    /// </summary>
+    Warn = -20,
+    /// <summary>
+    /// The operation failed for this entry; the archive can still be read
+    /// </summary>
+    Failed = -25,
+    /// <summary>
+    /// The archive cannot be read any further
+    /// </summary>
+    Fatal = -30
+}
@@ -0,0 +1,141 @@
+using System;
+using System.IO;
+using System.Runtime.CompilerServices;
+using System.Runtime.ExceptionServices;
+using System.Runtime.InteropServices;
+using static LibArchive.Net.Native;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// Base for managed data sources fed to libarchive through its read/skip/seek/close callbacks.
+/// The native side holds a GCHandle to the source as its client data until the source is disposed.
+/// Exceptions cannot cross the native frames, so they are captured here and rethrown by the reader.
+/// </summary>
+internal abstract class CallbackSource : IDisposable
+{
+    private const int ARCHIVE_OK = 0;
+    private const int ARCHIVE_FATAL = -30;
+
+    private GCHandle _self;
+    private ExceptionDispatchInfo? _error;
+
+    /// <summary>
+    /// Supply the next chunk of archive data
+    /// </summary>
+    /// <param name="buffer">Set to a pinned buffer which stays valid until the next call</param>
+    /// <returns>Number of bytes available, 0 at end of data</returns>
+    protected abstract int Read(out IntPtr buffer);
+
+    /// <summary>
+    /// Skip forward without reading, if possible
+    /// </summary>
+    /// <param name="request"></param>
+    /// <returns>Bytes actually skipped; 0 makes libarchive read and discard instead</returns>
+    protected virtual long Skip(long request) => 0;
+
+    protected virtual bool CanSeek => false;
+
+    protected virtual long Seek(long offset, SeekOrigin origin) => throw new NotSupportedException();
+
+    protected virtual void Close()
+    {
+    }
+
+    internal unsafe void Attach(IntPtr archive)
+    {
+        _self = GCHandle.Alloc(this);
+        archive_read_set_read_callback(archive, (IntPtr)(delegate* unmanaged[Cdecl]<IntPtr, IntPtr, IntPtr*, nint>)&ReadCallback);
+        archive_read_set_skip_callback(archive, (IntPtr)(delegate* unmanaged[Cdecl]<IntPtr, IntPtr, long, long>)&SkipCallback);
+        if (CanSeek)
+            archive_read_set_seek_callback(archive, (IntPtr)(delegate* unmanaged[Cdecl]<IntPtr, IntPtr, long, int, long>)&SeekCallback);
+        archive_read_set_close_callback(archive, (IntPtr)(delegate* unmanaged[Cdecl]<IntPtr, IntPtr, int>)&CloseCallback);
+        archive_read_set_callback_data(archive, GCHandle.ToIntPtr(_self));
+    }
+
+    /// <summary>
+    /// Rethrow, once, any exception captured inside a callback
+    /// </summary>
+    internal void ThrowIfFailed()
+    {
+        var error = _error;
+        _error = null;
+        error?.Throw();
+    }
+
+    public void Dispose()
+    {
+        if (_self.IsAllocated)
+            _self.Free();
+    }
+
+    private static CallbackSource From(IntPtr client) => (CallbackSource)GCHandle.FromIntPtr(client).Target!;
+
+    [UnmanagedCallersOnly(CallConvs = new[] { typeof(CallConvCdecl) })]
+    private static unsafe nint ReadCallback(IntPtr archive, IntPtr client, IntPtr* buffer)
+    {
+        var source = From(client);
+        // Once a skip has failed, fail the read libarchive falls back to as well
+        if (source._error != null)
+            return ARCHIVE_FATAL;
+        try
+        {
+            var r = source.Read(out var ptr);
+            *buffer = ptr;
+            return r;
+        }
+        catch (Exception e)
+        {
+            source._error = ExceptionDispatchInfo.Capture(e);
+            return ARCHIVE_FATAL;
+        }
+    }
+
+    [UnmanagedCallersOnly(CallConvs = new[] { typeof(CallConvCdecl) })]
+    private static long SkipCallback(IntPtr archive, IntPtr client, long request)
+    {
+        var source = From(client);
+        try
+        {
+            return source.Skip(request);
+        }
+        catch (Exception e)
+        {
+            // libarchive takes any skip result as a byte count, so the error is reported by the read
+            // it falls back to on 0 rather than here
+            source._error = ExceptionDispatchInfo.Capture(e);
+            return 0;
+        }
+    }
+
+    [UnmanagedCallersOnly(CallConvs = new[] { typeof(CallConvCdecl) })]
+    private static long SeekCallback(IntPtr archive, IntPtr client, long offset, int whence)
+    {
+        var source = From(client);
+        try
+        {
+            return source.Seek(offset, (SeekOrigin)whence);
+        }
+        catch (Exception e)
+        {
+            source._error = ExceptionDispatchInfo.Capture(e);
+            return ARCHIVE_FATAL;
+        }
+    }
+
+    [UnmanagedCallersOnly(CallConvs = new[] { typeof(CallConvCdecl) })]
+    private static int CloseCallback(IntPtr archive, IntPtr client)
+    {
+        var source = From(client);
+        try
+        {
+            source.Close();
+            return ARCHIVE_OK;
+        }
+        catch (Exception e)
+        {
+            source._error = ExceptionDispatchInfo.Capture(e);
+            return ARCHIVE_FATAL;
+        }
+    }
+}
@@ -0,0 +1,77 @@
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// A TaskScheduler running work on a fixed set of dedicated threads, used for the blocking native
+/// calls behind the async reader APIs so they never tie up shared thread-pool threads.
+/// </summary>
+public sealed class DecompressionScheduler : TaskScheduler, IDisposable
+{
+    private static readonly Lazy<DecompressionScheduler> _default = new(() => new DecompressionScheduler(Environment.ProcessorCount));
+
+    [ThreadStatic]
+    private static DecompressionScheduler? _current;
+
+    private readonly BlockingCollection<Task> _queue = new();
+    private readonly Thread[] _threads;
+
+    /// <summary>
+    /// Shared scheduler with one thread per core, created on first use
+    /// </summary>
+    public static new DecompressionScheduler Default => _default.Value;
+
+    /// <summary>
+    /// Start threadCount dedicated background threads
+    /// </summary>
+    /// <param name="threadCount"></param>
+    public DecompressionScheduler(int threadCount)
+    {
+        if (threadCount < 1)
+            throw new ArgumentOutOfRangeException(nameof(threadCount));
+        _threads = new Thread[threadCount];
+        for (var i = 0; i < threadCount; i++)
+        {
+            _threads[i] = new Thread(Run)
+            {
+                IsBackground = true,
+                Name = $"LibArchive decompression {i}"
+            };
+            _threads[i].Start();
+        }
+    }
+
+    public override int MaximumConcurrencyLevel => _threads.Length;
+
+    private void Run()
+    {
+        _current = this;
+        foreach (var task in _queue.GetConsumingEnumerable())
+            TryExecuteTask(task);
+    }
+
+    protected override void QueueTask(Task task)
+    {
+        _queue.Add(task);
+    }
+
+    protected override bool TryExecuteTaskInline(Task task, bool taskWasPreviouslyQueued)
+    {
+        // Only run inline when already on one of our threads, otherwise the caller's thread would block in native code
+        return _current == this && TryExecuteTask(task);
+    }
+
+    protected override IEnumerable<Task> GetScheduledTasks() => _queue.ToArray();
+
+    /// <summary>
+    /// Stop accepting work; the threads exit once the queue drains
+    /// </summary>
+    public void Dispose()
+    {
+        _queue.CompleteAdding();
+    }
+}
@@ -0,0 +1,88 @@
+using System;
+using System.Linq;
+using System.Text;
+using Microsoft.Win32.SafeHandles;
+using static LibArchive.Net.Native;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// Decide from an entry's raw UTF-8 path whether to return it; the span is only valid during the call
+/// </summary>
+public delegate bool PathFilter(ReadOnlySpan<byte> utf8Path);
+
+/// <summary>
+/// Include/exclude patterns evaluated natively by libarchive's archive_match against each header.
+/// Patterns follow tar conventions: shell wildcards, and a pattern naming a directory also matches
+/// everything beneath it. With no include patterns, everything not excluded is included.
+/// </summary>
+public class EntryFilter : SafeHandleZeroOrMinusOneIsInvalid
+{
+    public EntryFilter() : base(true)
+    {
+        handle = archive_match_new();
+    }
+
+    /// <summary>
+    /// Return only entries matching pattern (or any other include pattern)
+    /// </summary>
+    /// <param name="pattern"></param>
+    /// <returns>this, for chaining</returns>
+    public EntryFilter Include(string pattern)
+    {
+        using var uPattern = new SafeStringBuffer(pattern);
+        var r = archive_match_include_pattern(handle, uPattern.Ptr);
+        if (r != 0)
+            Throw(r);
+        return this;
+    }
+
+    /// <summary>
+    /// Never return entries matching pattern
+    /// </summary>
+    /// <param name="pattern"></param>
+    /// <returns>this, for chaining</returns>
+    public EntryFilter Exclude(string pattern)
+    {
+        using var uPattern = new SafeStringBuffer(pattern);
+        var r = archive_match_exclude_pattern(handle, uPattern.Ptr);
+        if (r != 0)
+            Throw(r);
+        return this;
+    }
+
+    /// <summary>
+    /// A PathFilter accepting paths which start with any of the given prefixes, compared as raw UTF-8
+    /// </summary>
+    /// <param name="prefixes"></param>
+    /// <returns></returns>
+    public static PathFilter StartsWith(params string[] prefixes)
+    {
+        var encoded = prefixes.Select(p => Encoding.UTF8.GetBytes(p)).ToArray();
+        return path =>
+        {
+            foreach (var prefix in encoded)
+                if (path.StartsWith(prefix))
+                    return true;
+            return false;
+        };
+    }
+
+    internal bool Excludes(IntPtr entry)
+    {
+        var r = archive_match_path_excluded(handle, entry);
+        if (r < 0)
+            Throw(r);
+        return r != 0;
+    }
+
+    private void Throw(int result)
+    {
+        throw ArchiveException.From(handle, result, "Pattern matching failed");
+    }
+
+    protected override bool ReleaseHandle()
+    {
+        return archive_match_free(handle) == 0;
+    }
+}
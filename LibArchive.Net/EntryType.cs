@@ -0,0 +1,16 @@
+namespace LibArchive.Net;
+
+/// <summary>
+/// Entry file types, using libarchive's AE_IF* values
+/// </summary>
+public enum EntryType
+{
+    Unknown = 0,
+    Fifo = 0x1000,
+    CharacterDevice = 0x2000,
+    Directory = 0x4000,
+    BlockDevice = 0x6000,
+    File = 0x8000,
+    Symlink = 0xA000,
+    Socket = 0xC000
+}
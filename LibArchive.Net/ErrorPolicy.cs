@@ -0,0 +1,24 @@
+namespace LibArchive.Net;
+
+/// <summary>
+/// Which libarchive results a LibArchiveReader lets pass when reading headers and data, rather
+/// than throwing an ArchiveException; set through ReaderOptions.ErrorPolicy. Those passed are
+/// counted in ReaderStatistics.Warnings.
+/// </summary>
+public enum ErrorPolicy
+{
+    /// <summary>
+    /// Throw on anything but ARCHIVE_OK
+    /// </summary>
+    Strict,
+    /// <summary>
+    /// Accept entries and data libarchive warns about, and try again on ARCHIVE_RETRY
+    /// </summary>
+    ContinueOnWarning,
+    /// <summary>
+    /// As ContinueOnWarning, and also pass over entries whose header libarchive fails to read
+    /// (ARCHIVE_FAILED), stopping only on ARCHIVE_FATAL. A failure in an entry's data still throws,
+    /// after which the next entry can be read as usual.
+    /// </summary>
+    SkipFailedEntries
+}
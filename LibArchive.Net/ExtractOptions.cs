@@ -0,0 +1,67 @@
+namespace LibArchive.Net;
+
+/// <summary>
+/// What LibArchiveReader.ExtractTo restores besides file contents, and how it treats paths
+/// </summary>
+public sealed class ExtractOptions
+{
+    private const int ARCHIVE_EXTRACT_OWNER = 0x1;
+    private const int ARCHIVE_EXTRACT_PERM = 0x2;
+    private const int ARCHIVE_EXTRACT_TIME = 0x4;
+    private const int ARCHIVE_EXTRACT_NO_OVERWRITE = 0x8;
+    private const int ARCHIVE_EXTRACT_ACL = 0x20;
+    private const int ARCHIVE_EXTRACT_FFLAGS = 0x40;
+    private const int ARCHIVE_EXTRACT_XATTR = 0x80;
+    private const int ARCHIVE_EXTRACT_SECURE_SYMLINKS = 0x100;
+    private const int ARCHIVE_EXTRACT_SECURE_NODOTDOT = 0x200;
+
+    /// <summary>
+    /// Permissions and timestamps, overwriting existing files, secure paths, no preallocation
+    /// </summary>
+    public static ExtractOptions Default { get; } = new();
+
+    /// <summary>
+    /// Restore permission bits (less the umask unless running as root)
+    /// </summary>
+    public bool Permissions { get; init; } = true;
+
+    /// <summary>
+    /// Restore modification and access times
+    /// </summary>
+    public bool Timestamps { get; init; } = true;
+
+    /// <summary>
+    /// Restore owner and group, looking up names before ids; normally only possible as root
+    /// </summary>
+    public bool Owner { get; init; }
+
+    /// <summary>
+    /// Restore extended attributes, ACLs and file flags where the platform supports them
+    /// </summary>
+    public bool ExtendedAttributes { get; init; }
+
+    /// <summary>
+    /// Replace existing files; otherwise entries whose path already exists are skipped
+    /// </summary>
+    public bool Overwrite { get; init; } = true;
+
+    /// <summary>
+    /// Refuse entries with ".." path components, and refuse to extract through symlinks, so nothing
+    /// can be written outside the target directory. Leading '/' is always stripped.
+    /// </summary>
+    public bool SecurePaths { get; init; } = true;
+
+    /// <summary>
+    /// Reserve each regular file's full size before writing it, avoiding fragmentation of large
+    /// files (sparse holes are allocated too). Ignored on Windows.
+    /// </summary>
+    public bool Preallocate { get; init; }
+
+    internal int Flags =>
+        (Owner ? ARCHIVE_EXTRACT_OWNER : 0) |
+        (Permissions ? ARCHIVE_EXTRACT_PERM : 0) |
+        (Timestamps ? ARCHIVE_EXTRACT_TIME : 0) |
+        (Overwrite ? 0 : ARCHIVE_EXTRACT_NO_OVERWRITE) |
+        (ExtendedAttributes ? ARCHIVE_EXTRACT_XATTR | ARCHIVE_EXTRACT_ACL | ARCHIVE_EXTRACT_FFLAGS : 0) |
+        (SecurePaths ? ARCHIVE_EXTRACT_SECURE_SYMLINKS | ARCHIVE_EXTRACT_SECURE_NODOTDOT : 0);
+}
@@ -0,0 +1,57 @@
+using System;
+using System.Collections.Generic;
+using System.Diagnostics.Metrics;
+using System.Diagnostics.Tracing;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// Publishes each reader's ReaderStatistics when it is disposed: as a ReaderClosed event, and as
+/// counters tagged with format and filters on the "LibArchive.Net" Meter for dotnet-counters or
+/// OpenTelemetry. Nothing is computed unless a listener is attached.
+/// </summary>
+[EventSource(Name = "LibArchive.Net")]
+internal sealed class LibArchiveEventSource : EventSource
+{
+    public static readonly LibArchiveEventSource Log = new();
+
+    private static readonly Meter Meter = new("LibArchive.Net");
+    private static readonly Counter<long> Readers = Meter.CreateCounter<long>("libarchive.read.archives", "{archive}", "Readers disposed");
+    private static readonly Counter<long> Compressed = Meter.CreateCounter<long>("libarchive.read.compressed_bytes", "By", "Input bytes consumed");
+    private static readonly Counter<long> Uncompressed = Meter.CreateCounter<long>("libarchive.read.uncompressed_bytes", "By", "Entry data bytes produced");
+    private static readonly Counter<long> Headers = Meter.CreateCounter<long>("libarchive.read.headers", "{header}", "Entry headers read");
+    private static readonly Counter<long> Warnings = Meter.CreateCounter<long>("libarchive.read.warnings", "{warning}", "Warnings and failures let pass by ErrorPolicy");
+    private static readonly Counter<double> NativeTime = Meter.CreateCounter<double>("libarchive.read.native_time", "s", "Time inside libarchive header and data calls");
+
+    private LibArchiveEventSource()
+    {
+    }
+
+    internal static bool Enabled => Log.IsEnabled() || Readers.Enabled;
+
+    internal static void Publish(ReaderStatistics stats)
+    {
+        if (Log.IsEnabled())
+            Log.ReaderClosed(stats.Format, stats.Filters, stats.CompressedBytes, stats.UncompressedBytes, stats.Headers,
+                stats.HeaderTime.TotalMilliseconds, stats.DataTime.TotalMilliseconds);
+        if (!Readers.Enabled)
+            return;
+        var format = new KeyValuePair<string, object?>("format", stats.Format);
+        var filters = new KeyValuePair<string, object?>("filters", stats.Filters);
+        Readers.Add(1, format, filters);
+        Compressed.Add(stats.CompressedBytes, format, filters);
+        Uncompressed.Add(stats.UncompressedBytes, format, filters);
+        Headers.Add(stats.Headers, format, filters);
+        if (stats.Warnings > 0)
+            Warnings.Add(stats.Warnings, format, filters);
+        NativeTime.Add(stats.HeaderTime.TotalSeconds, format, filters, new KeyValuePair<string, object?>("call", "header"));
+        NativeTime.Add(stats.DataTime.TotalSeconds, format, filters, new KeyValuePair<string, object?>("call", "data"));
+    }
+
+    [Event(1, Level = EventLevel.Informational, Message = "{0} ({1}): {2} bytes in, {3} bytes out, {4} headers")]
+    public void ReaderClosed(string format, string filters, long compressedBytes, long uncompressedBytes, int headers,
+        double headerMilliseconds, double dataMilliseconds)
+    {
+        WriteEvent(1, format, filters, compressedBytes, uncompressedBytes, headers, headerMilliseconds, dataMilliseconds);
+    }
+}
@@ -1,10 +1,18 @@
 ﻿using System;
+using System.Buffers;
 using System.Collections.Generic;
+using System.Diagnostics;
 using System.IO;
+using System.Runtime.CompilerServices;
 using System.Runtime.InteropServices;
+using System.Security.Cryptography;
+using System.Text;
+using System.Threading;
+using System.Threading.Channels;
+using System.Threading.Tasks;
 using Microsoft.Win32.SafeHandles;
+using static LibArchive.Net.Native;
 
-[assembly: DefaultDllImportSearchPaths(DllImportSearchPath.AssemblyDirectory)]
 namespace LibArchive.Net;
 
 public class LibArchiveReader : SafeHandleZeroOrMinusOneIsInvalid
@@ -19,85 +27,1588 @@ public class LibArchiveReader : SafeHandleZeroOrMinusOneIsInvalid
         ARCHIVE_FATAL=-30
     }
 
-    static LibArchiveReader()
+    private const uint AE_IFMT = 0xF000;
+    // Written out or hashed for the holes in sparse entries
+    private static readonly byte[] Zeros = new byte[1 << 16];
+
+    private CallbackSource? _source;
+    private MemoryHandle _pin;
+    private MappedFile? _mapping;
+    private int _serial;
+    private readonly LibArchiveReaderPool? _pool;
+    private ReaderOptions? _options;
+    private string? _filename;
+    private ReadOnlyMemory<byte> _memory;
+    private uint _blockSize = 1<<20;
+    private ArchiveIndex? _index;
+    private LibArchiveReader? _lookup;
+    // The one Entry given out by ReuseEntries
+    private Entry? _reused;
+    // Where a reader opened part-way into the file started: its offset and the ordinal of its first header
+    private long _baseOffset;
+    private int _ordinalBase;
+    // Set by Dispose even while a SeekableEntryStream still holds the handle open
+    private volatile bool _disposed;
+    // _serial when entry data was last read, and how much of that entry ReadData has returned
+    private int _readSerial;
+    private long _entryRead;
+    // For Statistics
+    private int _headers;
+    private long _uncompressed;
+    private long _headerTicks;
+    private long _dataTicks;
+    private int _warnings;
+
+    private LibArchiveReader(ReaderOptions? options) : base(true)
+    {
+        handle = archive_read_new();
+        _options = options;
+        var r = (options ?? ReaderOptions.Default).Apply(handle);
+        if (r != (int)ARCHIVE_RESULT.ARCHIVE_OK)
+            Throw(r);
+    }
+
+    /// <summary>
+    /// Wrap a handle already configured by pool with options, ready to be opened
+    /// </summary>
+    internal LibArchiveReader(IntPtr configured, LibArchiveReaderPool pool, ReaderOptions options) : base(true)
+    {
+        handle = configured;
+        _pool = pool;
+        _options = options;
+    }
+
+    /// <summary>
+    /// Open the named archive for read access with the specified block size
+    /// </summary>
+    /// <param name="filename"></param>
+    /// <param name="blockSize">Block size in bytes, default 1 MiB</param>
+    /// <param name="options">Formats, filters and options to use, default all formats and filters</param>
+    /// <exception cref="ArchiveException"></exception>
+    public LibArchiveReader(string filename,uint blockSize = 1<<20, ReaderOptions? options = null) : this(options)
+    {
+        OpenFile(filename, blockSize);
+    }
+
+    internal void OpenFile(string filename, uint blockSize)
+    {
+        var r = TryOpenFile(filename, blockSize);
+        if (r != (int)ARCHIVE_RESULT.ARCHIVE_OK)
+            Throw(r);
+    }
+
+    /// <summary>
+    /// Open the named archive as the constructor does, but report failure as a status code rather
+    /// than an exception, e.g. when scanning a corpus in which many files are not archives at all
+    /// </summary>
+    /// <param name="filename"></param>
+    /// <param name="reader">The open reader, or null if the result is Failed or Fatal</param>
+    /// <param name="blockSize">Block size in bytes, default 1 MiB</param>
+    /// <param name="options">Formats, filters and options to use, default all formats and filters</param>
+    /// <returns>Ok, or Warn if options.ErrorPolicy let a warning pass; otherwise Failed or Fatal, with no reader</returns>
+    public static ArchiveResult TryOpen(string filename, out LibArchiveReader? reader, uint blockSize = 1<<20, ReaderOptions? options = null)
+    {
+        reader = new LibArchiveReader(options);
+        var r = reader.TryOpenFile(filename, blockSize);
+        if (r == (int)ARCHIVE_RESULT.ARCHIVE_OK)
+            return reader._warnings > 0 ? ArchiveResult.Warn : ArchiveResult.Ok;
+        reader.Dispose();
+        reader = null;
+        // A warning the ErrorPolicy did not let pass still leaves no reader
+        return r == (int)ARCHIVE_RESULT.ARCHIVE_FATAL ? ArchiveResult.Fatal : ArchiveResult.Failed;
+    }
+
+    private int TryOpenFile(string filename, uint blockSize)
+    {
+        using var uName = new SafeStringBuffer(filename);
+        var r = archive_read_open_filename(handle, uName.Ptr, blockSize);
+        if (r != (int)ARCHIVE_RESULT.ARCHIVE_OK && !Passes(r))
+            return r;
+        _filename = filename;
+        _blockSize = blockSize;
+        return (int)ARCHIVE_RESULT.ARCHIVE_OK;
+    }
+
+    /// <summary>
+    /// Open an archive read from a Stream, starting at its current position. Reads go through a
+    /// pinned buffer of blockSize bytes; if the stream is seekable, libarchive may also seek and
+    /// skip within it, which seek-heavy formats such as zip and 7z need.
+    /// </summary>
+    /// <param name="stream"></param>
+    /// <param name="blockSize">Block size in bytes, default 1 MiB</param>
+    /// <param name="leaveOpen">Leave the stream open when the reader is disposed</param>
+    /// <param name="options">Formats, filters and options to use, default all formats and filters</param>
+    /// <exception cref="ArchiveException"></exception>
+    public LibArchiveReader(Stream stream, uint blockSize = 1<<20, bool leaveOpen = false, ReaderOptions? options = null) : this(options)
+    {
+        if (stream is null)
+            throw new ArgumentNullException(nameof(stream));
+        OpenSource(new StreamSource(stream, (int)blockSize, leaveOpen));
+    }
+
+    /// <summary>
+    /// Open a split or multi-volume archive, such as name.7z.001, name.7z.002, ... or name.part1.rar,
+    /// name.part2.rar, ..., from its volume files in order, without joining them first. The next
+    /// block, and so the next volume, is read ahead while libarchive decompresses the current one.
+    /// </summary>
+    /// <param name="volumes">The volume files, first to last</param>
+    /// <param name="blockSize">Block size in bytes, default 1 MiB</param>
+    /// <param name="options">Formats, filters and options to use, default all formats and filters</param>
+    /// <exception cref="ArchiveException"></exception>
+    public LibArchiveReader(IEnumerable<string> volumes, uint blockSize = 1<<20, ReaderOptions? options = null) : this(options)
+    {
+        if (volumes is null)
+            throw new ArgumentNullException(nameof(volumes));
+        var streams = new List<Stream>();
+        try
+        {
+            foreach (var volume in volumes)
+                streams.Add(new System.IO.FileStream(volume, FileMode.Open, FileAccess.Read, FileShare.Read, 0, FileOptions.SequentialScan));
+        }
+        catch
+        {
+            foreach (var stream in streams)
+                stream.Dispose();
+            throw;
+        }
+        OpenSource(new VolumeSource(streams, (int)blockSize, false));
+    }
+
+    /// <summary>
+    /// Open a split or multi-volume archive from a Stream per volume, in order, each starting at its
+    /// current position. As for a single Stream, libarchive may seek within the set only if every
+    /// stream is seekable.
+    /// </summary>
+    /// <param name="volumes">The volumes, first to last</param>
+    /// <param name="blockSize">Block size in bytes, default 1 MiB</param>
+    /// <param name="leaveOpen">Leave the streams open when the reader is disposed</param>
+    /// <param name="options">Formats, filters and options to use, default all formats and filters</param>
+    /// <exception cref="ArchiveException"></exception>
+    public LibArchiveReader(IEnumerable<Stream> volumes, uint blockSize = 1<<20, bool leaveOpen = false, ReaderOptions? options = null) : this(options)
+    {
+        if (volumes is null)
+            throw new ArgumentNullException(nameof(volumes));
+        OpenSource(new VolumeSource(new List<Stream>(volumes), (int)blockSize, leaveOpen));
+    }
+
+    internal void OpenSource(CallbackSource source)
+    {
+        _source = source;
+        _source.Attach(handle);
+        Check(archive_read_open1(handle));
+    }
+
+    /// <summary>
+    /// Open an archive already resident in memory. The memory is pinned until the reader is disposed
+    /// and must not be modified in the meantime.
+    /// </summary>
+    /// <param name="archive"></param>
+    /// <param name="options">Formats, filters and options to use, default all formats and filters</param>
+    /// <exception cref="ArchiveException"></exception>
+    public LibArchiveReader(ReadOnlyMemory<byte> archive, ReaderOptions? options = null) : this(options)
+    {
+        OpenMemory(archive);
+    }
+
+    internal unsafe void OpenMemory(ReadOnlyMemory<byte> archive)
+    {
+        _pin = archive.Pin();
+        _memory = archive;
+        Check(archive_read_open_memory(handle, (IntPtr)_pin.Pointer, (nuint)archive.Length));
+    }
+
+    /// <summary>
+    /// Open the named archive by mapping it into memory instead of reading it in blocks. Seek-heavy
+    /// formats such as zip and 7z then read straight from the page cache with no read() calls, and
+    /// several readers of the same file share the same physical pages.
+    /// </summary>
+    /// <param name="filename"></param>
+    /// <param name="options">Formats, filters and options to use, default all formats and filters</param>
+    /// <returns></returns>
+    /// <exception cref="ArchiveException"></exception>
+    public static LibArchiveReader OpenMapped(string filename, ReaderOptions? options = null)
+    {
+        var mapping = new MappedFile(filename);
+        try
+        {
+            return new LibArchiveReader(mapping, options) { _filename = filename };
+        }
+        catch
+        {
+            mapping.Dispose();
+            throw;
+        }
+    }
+
+    private LibArchiveReader(MappedFile mapping, ReaderOptions? options) : this(options)
+    {
+        Check(archive_read_open_memory(handle, mapping.Ptr, (nuint)mapping.Length));
+        _mapping = mapping;
+    }
+
+    /// <summary>
+    /// Open the named archive with up to queueDepth block reads in flight ahead of libarchive, for
+    /// network filesystems (NFS, EFS, SMB) and other storage where every synchronous read would
+    /// stall the decompressor for a round trip.
+    /// </summary>
+    /// <param name="filename"></param>
+    /// <param name="queueDepth">Block reads kept in flight, default 4</param>
+    /// <param name="blockSize">Block size in bytes, default 1 MiB</param>
+    /// <param name="sequentialScan">Tell the OS the file is read front to back (FILE_FLAG_SEQUENTIAL_SCAN,
+    /// posix_fadvise); worth turning off for zip and 7z, which seek to their central directory</param>
+    /// <param name="options">Formats, filters and options to use, default all formats and filters</param>
+    /// <returns></returns>
+    /// <exception cref="ArchiveException"></exception>
+    public static LibArchiveReader OpenPrefetched(string filename, int queueDepth = 4, uint blockSize = 1<<20, bool sequentialScan = true, ReaderOptions? options = null)
+    {
+        var reader = new LibArchiveReader(options) { _filename = filename, _blockSize = blockSize };
+        try
+        {
+            reader.OpenSource(new PrefetchSource(filename, queueDepth, (int)blockSize, sequentialScan));
+            return reader;
+        }
+        catch
+        {
+            reader.Dispose();
+            throw;
+        }
+    }
+
+    /// <summary>
+    /// Whether entries can be reached without decoding everything before them: an unfiltered zip,
+    /// 7z or ISO image, whose headers carry offsets libarchive can seek to.
+    /// Only meaningful once at least one header has been read.
+    /// </summary>
+    internal bool IsRandomAccess
+    {
+        get
+        {
+            const int ARCHIVE_FILTER_NONE = 0;
+            const int ARCHIVE_FORMAT_BASE_MASK = unchecked((int)0xff0000);
+            const int ARCHIVE_FORMAT_ISO9660 = 0x40000;
+            const int ARCHIVE_FORMAT_ZIP = 0x50000;
+            const int ARCHIVE_FORMAT_7ZIP = 0xE0000;
+            if (archive_filter_code(handle, 0) != ARCHIVE_FILTER_NONE)
+                return false;
+            return (archive_format(handle) & ARCHIVE_FORMAT_BASE_MASK) is ARCHIVE_FORMAT_ISO9660 or ARCHIVE_FORMAT_ZIP or ARCHIVE_FORMAT_7ZIP;
+        }
+    }
+
+    private ErrorPolicy Policy => (_options ?? ReaderOptions.Default).ErrorPolicy;
+
+    /// <summary>
+    /// Whether the ErrorPolicy lets a result other than ARCHIVE_OK pass, counting it if so
+    /// </summary>
+    private bool Passes(int r)
+    {
+        var passes = r switch
+        {
+            (int)ARCHIVE_RESULT.ARCHIVE_WARN or (int)ARCHIVE_RESULT.ARCHIVE_RETRY => Policy != ErrorPolicy.Strict,
+            _ => false
+        };
+        if (passes)
+            _warnings++;
+        return passes;
+    }
+
+    /// <summary>
+    /// Throw unless r is ARCHIVE_OK or a warning the ErrorPolicy lets pass
+    /// </summary>
+    private void Check(int r)
+    {
+        if (r != (int)ARCHIVE_RESULT.ARCHIVE_OK && !Passes(r))
+            Throw(r);
+    }
+
+    /// <summary>
+    /// As Check, for a result from the disk writer used by ExtractTo
+    /// </summary>
+    private void Check(IntPtr disk, int r)
+    {
+        if (r != (int)ARCHIVE_RESULT.ARCHIVE_OK && !Passes(r))
+            throw ArchiveException.From(disk, r, "Extraction failed");
+    }
+
+    private void Throw(int r)
+    {
+        // An exception thrown by a managed callback takes precedence over libarchive's report of it
+        _source?.ThrowIfFailed();
+        throw ArchiveException.From(handle, r, "Archive read failed");
+    }
+
+    protected override void Dispose(bool disposing)
+    {
+        _disposed = true;
+        if (disposing)
+            _lookup?.Dispose();
+        base.Dispose(disposing);
+    }
+
+    internal bool IsDisposed => _disposed;
+
+    /// <summary>
+    /// Bytes, headers and time inside libarchive so far
+    /// </summary>
+    /// <exception cref="ObjectDisposedException"></exception>
+    public ReaderStatistics Statistics
+    {
+        get
+        {
+            using var lease = new Lease(this);
+            return Snapshot();
+        }
+    }
+
+    private ReaderStatistics Snapshot()
+    {
+        var filters = new StringBuilder();
+        var count = archive_filter_count(handle);
+        // Filter 0 is nearest the archive data, and the last is the client reading the source, reported as "none"
+        for (var i = 0; i < count - 1; i++)
+            filters.Append(i > 0 ? "+" : "").Append(Marshal.PtrToStringUTF8(archive_filter_name(handle, i)));
+        return new ReaderStatistics(
+            _headers > 0 ? Marshal.PtrToStringUTF8(archive_format_name(handle)) ?? "" : "",
+            filters.Length > 0 ? filters.ToString() : "none",
+            archive_filter_bytes(handle, -1),
+            _uncompressed,
+            _headers,
+            TimeSpan.FromSeconds(_headerTicks / (double)Stopwatch.Frequency),
+            TimeSpan.FromSeconds(_dataTicks / (double)Stopwatch.Frequency),
+            _warnings);
+    }
+
+    protected override bool ReleaseHandle()
+    {
+        if (LibArchiveEventSource.Enabled)
+            LibArchiveEventSource.Publish(Snapshot());
+        var r = archive_read_free(handle) == 0;
+        _source?.Dispose();
+        if (_pool is not null && _source is StreamSource stream)
+            _pool.Return(stream.Buffer);
+        _pin.Dispose();
+        _mapping?.Dispose();
+        return r;
+    }
+
+    /// <summary>
+    /// Scheduler used for the blocking native calls behind EntriesAsync and FileStream.ReadAsync
+    /// </summary>
+    public TaskScheduler Scheduler { get; set; } = DecompressionScheduler.Default;
+
+    public IEnumerable<Entry> Entries()
+    {
+        while (NextEntry() is { } entry)
+            yield return entry;
+    }
+
+    /// <summary>
+    /// Enumerate only entries whose raw UTF-8 path is accepted by filter. Rejected entries are
+    /// tested against libarchive's pathname pointer and skipped inside the header loop, with no
+    /// string or Entry allocated for them.
+    /// </summary>
+    /// <param name="filter"></param>
+    /// <returns></returns>
+    public IEnumerable<Entry> Entries(PathFilter filter)
+    {
+        if (filter is null)
+            throw new ArgumentNullException(nameof(filter));
+        while (NextEntry(filter) is { } entry)
+            yield return entry;
+    }
+
+    /// <summary>
+    /// Enumerate only entries not excluded by filter's native include/exclude patterns
+    /// </summary>
+    /// <param name="filter"></param>
+    /// <returns></returns>
+    public IEnumerable<Entry> Entries(EntryFilter filter)
+    {
+        if (filter is null)
+            throw new ArgumentNullException(nameof(filter));
+        while (NextEntry(null, filter) is { } entry)
+            yield return entry;
+    }
+
+    /// <summary>
+    /// Give action every entry whose path is in paths, in one forward pass over the archive. A solid
+    /// 7z or rar archive is decompressed at most once, where a reader per wanted file would decompress
+    /// everything before each file again. Other entries are skipped as cheaply as the format allows,
+    /// with no string or Entry allocated, and the pass stops once every path has been seen without
+    /// reading any further headers or data; the reader may then go on to enumerate what follows.
+    /// Paths are compared with the raw UTF-8 pathnames, and only the first entry with each path is
+    /// given to action. For a predicate rather than a set of paths, Entries(PathFilter) makes the
+    /// same single pass.
+    /// </summary>
+    /// <param name="paths"></param>
+    /// <param name="action">Called with each wanted entry, which is only valid until action returns</param>
+    /// <param name="cancellationToken"></param>
+    /// <returns>The number of distinct paths found</returns>
+    /// <exception cref="ArchiveException"></exception>
+    public unsafe int Process(IEnumerable<string> paths, Action<Entry> action, CancellationToken cancellationToken = default)
+    {
+        if (paths is null)
+            throw new ArgumentNullException(nameof(paths));
+        if (action is null)
+            throw new ArgumentNullException(nameof(action));
+
+        var wanted = new Utf8PathSet(paths);
+        var seen = new bool[wanted.Count];
+        var found = 0;
+        var r = 0;
+        IntPtr entry;
+        while (found < wanted.Count && (r = NextHeader(&entry)) == 0)
+        {
+            cancellationToken.ThrowIfCancellationRequested();
+            var path = archive_entry_pathname(entry);
+            if (path == IntPtr.Zero)
+                continue;
+            var i = wanted.IndexOf(MemoryMarshal.CreateReadOnlySpanFromNullTerminated((byte*)path));
+            if (i < 0 || seen[i])
+            {
+                SkipData();
+                continue;
+            }
+            seen[i] = true;
+            found++;
+            action(new Entry(this, entry));
+        }
+
+        if (r != (int)ARCHIVE_RESULT.ARCHIVE_OK && r != (int)ARCHIVE_RESULT.ARCHIVE_EOF)
+            Throw(r);
+        return found;
+    }
+
+    /// <summary>
+    /// Enumerate entries without allocating: one Entry, and one FileStream from its Stream property,
+    /// are reused for every header, so each is only valid until MoveNext. Names are still decoded
+    /// into a new string if Name is read; use PathUtf8 to avoid that. The enumerator is a ref struct
+    /// so that entries cannot be collected or carried across an await by mistake.
+    /// </summary>
+    /// <param name="filter">If set, only entries whose raw UTF-8 path it accepts</param>
+    /// <returns></returns>
+    public EntryEnumerator ReuseEntries(PathFilter? filter = null)
+    {
+        return new EntryEnumerator(this, filter);
+    }
+
+    /// <summary>
+    /// Read the next header without throwing on anything libarchive reports, for loops over
+    /// corrupt-heavy input where unwinding an exception per bad entry would cost too much. The
+    /// ErrorPolicy does not apply: every result is returned as it is.
+    /// </summary>
+    /// <param name="entry">The entry if the result is Ok or Warn, otherwise null</param>
+    /// <returns>Ok or Warn with an entry; Retry or Failed if this header is unusable but the next may
+    /// be read; Eof after the last; Fatal if the archive cannot be read further. ErrorMessage says why.</returns>
+    /// <exception cref="Exception">Whatever the Stream the reader was opened on threw</exception>
+    public unsafe ArchiveResult TryNextEntry(out Entry? entry)
+    {
+        IntPtr current;
+        var r = ReadHeader(&current);
+        if (r < (int)ARCHIVE_RESULT.ARCHIVE_WARN)
+            _source?.ThrowIfFailed();
+        entry = r is (int)ARCHIVE_RESULT.ARCHIVE_OK or (int)ARCHIVE_RESULT.ARCHIVE_WARN ? new Entry(this, current) : null;
+        return (ArchiveResult)r;
+    }
+
+    /// <summary>
+    /// libarchive's description of the last warning or error on this reader, e.g. one reported by a Try method
+    /// </summary>
+    /// <exception cref="ObjectDisposedException"></exception>
+    public string? ErrorMessage
+    {
+        get
+        {
+            using var lease = new Lease(this);
+            return Marshal.PtrToStringUTF8(archive_error_string(handle));
+        }
+    }
+
+    /// <summary>
+    /// archive_errno for the last warning or error on this reader (see ArchiveException.ErrorNumber)
+    /// </summary>
+    /// <exception cref="ObjectDisposedException"></exception>
+    public int ErrorNumber
+    {
+        get
+        {
+            using var lease = new Lease(this);
+            return archive_errno(handle);
+        }
+    }
+
+    /// <summary>
+    /// Enumerate entries with the header parsing (and any skipping of unread data) done on Scheduler
+    /// rather than the calling thread
+    /// </summary>
+    /// <param name="cancellationToken"></param>
+    /// <returns></returns>
+    public async IAsyncEnumerable<Entry> EntriesAsync([EnumeratorCancellation] CancellationToken cancellationToken = default)
+    {
+        while (await RunNative(() => NextEntry(), cancellationToken).ConfigureAwait(false) is { } entry)
+            yield return entry;
+    }
+
+    /// <summary>
+    /// List the remaining entries' metadata without reading their data: each header is followed by
+    /// an explicit archive_read_data_skip, and no Entry or Stream is allocated. Like Entries(), this
+    /// consumes the reader.
+    /// </summary>
+    /// <returns></returns>
+    /// <exception cref="ArchiveException"></exception>
+    public unsafe ArchiveEntryInfo[] List()
+    {
+        var list = new List<ArchiveEntryInfo>();
+        int r;
+        IntPtr entry;
+        while ((r=NextHeader(&entry))==0)
+        {
+            var name = Marshal.PtrToStringUTF8(archive_entry_pathname(entry));
+            if (name is not null)
+                list.Add(Info(name, entry));
+            SkipData();
+        }
+
+        if (r != (int)ARCHIVE_RESULT.ARCHIVE_EOF)
+            Throw(r);
+        return list.ToArray();
+    }
+
+    /// <summary>
+    /// Name index used by OpenEntry, built on first use by scanning the archive's headers. Assign an
+    /// index loaded from a sidecar file, or shared with other readers of the same file, to skip the scan.
+    /// </summary>
+    /// <exception cref="InvalidOperationException">The reader was not opened from a named file</exception>
+    /// <exception cref="ArgumentException">The index was built from a different version of the file</exception>
+    public ArchiveIndex Index
+    {
+        get => _index ??= ArchiveIndex.Build(IndexedFile, _options);
+        set
+        {
+            if (value is null)
+                throw new ArgumentNullException(nameof(value));
+            if (!value.IsCurrent(IndexedFile))
+                throw new ArgumentException("The index was built from a different version of the archive", nameof(value));
+            _index = value;
+        }
+    }
+
+    private string IndexedFile => _filename ?? throw new InvalidOperationException("Entry lookup needs a reader opened from a named file");
+
+    /// <summary>
+    /// Open the entry named path through Index, independently of Entries() on this reader. Where the
+    /// index has the entry's offset, a second reader starts at its header and reads nothing else;
+    /// otherwise the headers before it are read and their data skipped. The entry is usable until
+    /// the next call to OpenEntry or until this reader is disposed.
+    /// </summary>
+    /// <param name="path">Path within the archive, exactly as Entry.Name reports it</param>
+    /// <returns>The entry, or null if the archive has none of that name</returns>
+    /// <exception cref="ArchiveException">The archive could not be read</exception>
+    /// <exception cref="KeyNotFoundException">The archive no longer matches the index</exception>
+    public Entry? OpenEntry(string path)
+    {
+        if (path is null)
+            throw new ArgumentNullException(nameof(path));
+        var index = Index;
+        if (!index.TryGetLocation(path, out var ordinal, out var offset))
+            return null;
+        _lookup?.Dispose();
+        _lookup = null;
+        (_lookup, var entry) = Reopen(path, ordinal, offset, index.Format);
+        return entry;
+    }
+
+    private bool CanReopen => _filename is not null || _source is null && !_memory.IsEmpty;
+
+    /// <summary>
+    /// A new reader on the entry at ordinal named path, starting from its header at offset in the
+    /// file if known. Uses only where this reader's archive came from, not its handle, so it also
+    /// serves a SeekableEntryStream after the reader has moved on or been disposed.
+    /// </summary>
+    internal (LibArchiveReader, Entry) Reopen(string path, int ordinal, long offset, int format)
+    {
+        if (offset >= 0 && _filename is not null)
+        {
+            var direct = OpenAt(offset, format, ordinal);
+            try
+            {
+                if (direct.NextEntry() is { } found && found.Name == path)
+                    return (direct, found);
+            }
+            catch (ArchiveException)
+            {
+                // Not an entry header at that offset after all; fall back to reading from the start
+            }
+            direct.Dispose();
+        }
+
+        var scan = _filename is not null ? new LibArchiveReader(_filename, _blockSize, _options) : new LibArchiveReader(_memory, _options);
+        try
+        {
+            return (scan, scan.SkipTo(ordinal, path));
+        }
+        catch
+        {
+            scan.Dispose();
+            throw;
+        }
+    }
+
+    /// <summary>
+    /// A reader for a single format with no filters, starting at the header at offset within the
+    /// file, which is header number ordinal of the archive
+    /// </summary>
+    private LibArchiveReader OpenAt(long offset, int format, int ordinal)
+    {
+        const int ARCHIVE_FORMAT_ZIP = 0x50000;
+        var reader = new LibArchiveReader(Unregistered)
+        {
+            _options = _options,
+            _filename = _filename,
+            _blockSize = _blockSize,
+            _index = _index,
+            _baseOffset = offset,
+            _ordinalBase = ordinal
+        };
+        try
+        {
+            // The seekable zip reader would look for the central directory; read the local header directly
+            var r = format == ARCHIVE_FORMAT_ZIP
+                ? archive_read_support_format_zip_streamable(reader.handle)
+                : archive_read_support_format_by_code(reader.handle, format);
+            if (r != (int)ARCHIVE_RESULT.ARCHIVE_OK)
+                reader.Throw(r);
+            var file = new System.IO.FileStream(_filename!, FileMode.Open, FileAccess.Read, FileShare.Read, 0) { Position = offset };
+            reader.OpenSource(new StreamSource(file, (int)_blockSize, false));
+            return reader;
+        }
+        catch
+        {
+            reader.Dispose();
+            throw;
+        }
+    }
+
+    private static readonly ReaderOptions Unregistered = new() { Formats = ReadFormats.None, Filters = ReadFilters.None };
+
+    /// <summary>
+    /// Skip to the header at ordinal, which must be named path
+    /// </summary>
+    private unsafe Entry SkipTo(int ordinal, string path)
+    {
+        int r;
+        IntPtr entry;
+        for (var i = 0; (r=NextHeader(&entry))==0; i++)
+        {
+            if (i == ordinal)
+            {
+                var found = new Entry(this, entry);
+                return found.Name == path ? found : throw new KeyNotFoundException($"Entry {ordinal} is not '{path}'; the index is out of date");
+            }
+            SkipData();
+        }
+
+        if (r != (int)ARCHIVE_RESULT.ARCHIVE_EOF)
+            Throw(r);
+        throw new KeyNotFoundException($"The archive ended before '{path}'; the index is out of date");
+    }
+
+    /// <summary>
+    /// Decompress the current entry's next bytes into buffer
+    /// </summary>
+    /// <returns>Number of bytes read, 0 at the end of the entry</returns>
+    internal int ReadData(Span<byte> buffer)
+    {
+        int r;
+        while ((r = TryReadData(buffer)) < 0)
+            if (!Passes(r))
+                Throw(r);
+        return r;
+    }
+
+    /// <summary>
+    /// archive_read_data: the number of bytes read, 0 at the end of the entry, or a negative ARCHIVE_RESULT
+    /// </summary>
+    private unsafe int TryReadData(Span<byte> buffer)
+    {
+        using var lease = new Lease(this);
+        StartData();
+        nint r;
+        var start = Stopwatch.GetTimestamp();
+        fixed (byte* p = buffer)
+            r = archive_read_data(handle, p, (nuint)buffer.Length);
+        _dataTicks += Stopwatch.GetTimestamp() - start;
+        if (r < 0)
+            return (int)r;
+        _entryRead += r;
+        _uncompressed += r;
+        return (int)r;
+    }
+
+    internal int Serial => _serial;
+
+    private void StartData()
+    {
+        if (_readSerial == _serial)
+            return;
+        _readSerial = _serial;
+        _entryRead = 0;
+    }
+
+    /// <summary>
+    /// Append the current entry's remaining data to hash: libarchive's own blocks if none has been
+    /// read yet, with holes as zeros, otherwise through a pooled buffer
+    /// </summary>
+    private void AppendData(IncrementalHash hash)
     {
-        NativeLibrary.SetDllImportResolver(typeof(LibArchiveReader).Assembly,
-            (name, asm, path) =>
+        if (_readSerial != _serial)
+        {
+            long end = 0;
+            foreach (var block in new BlockEnumerator(this))
             {
-                // Currently supported: Linux+Win+OSX on x64, OSX only on arm64
-                if (RuntimeInformation.ProcessArchitecture != Architecture.X64 &&
-                    (RuntimeInformation.ProcessArchitecture != Architecture.Arm64 ||
-                     !RuntimeInformation.IsOSPlatform(OSPlatform.OSX)))
-                    throw new PlatformNotSupportedException();
-                if (RuntimeInformation.IsOSPlatform(OSPlatform.Linux))
-                    return NativeLibrary.Load($"{AppDomain.CurrentDomain.BaseDirectory}runtimes/linux-x64/libarchive.so");
-                if (RuntimeInformation.IsOSPlatform(OSPlatform.OSX))
-                    return NativeLibrary.Load($"{AppDomain.CurrentDomain.BaseDirectory}runtimes/osx-any64/libarchive.dylib");
-                if (RuntimeInformation.IsOSPlatform(OSPlatform.Windows))
-                    return NativeLibrary.Load($"{AppDomain.CurrentDomain.BaseDirectory}runtimes/win-x64/archive.dll");
-                throw new PlatformNotSupportedException();
-            });
+                for (var hole = block.Offset - end; hole > 0; hole -= Zeros.Length)
+                    hash.AppendData(Zeros, 0, (int)Math.Min(hole, Zeros.Length));
+                hash.AppendData(block.Data);
+                end = block.Offset + block.Data.Length;
+            }
+            return;
+        }
+
+        var buffer = ArrayPool<byte>.Shared.Rent(1 << 16);
+        try
+        {
+            int r;
+            while ((r = ReadData(buffer)) > 0)
+                hash.AppendData(buffer, 0, r);
+        }
+        finally
+        {
+            ArrayPool<byte>.Shared.Return(buffer);
+        }
     }
 
     /// <summary>
-    /// Open the named archive for read access with the specified block size
+    /// Read the current entry's data until buffer is full or the entry ends
     /// </summary>
-    /// <param name="filename"></param>
-    /// <param name="blockSize">Block size in bytes, default 1 MiB</param>
-    /// <exception cref="ApplicationException"></exception>
-    public LibArchiveReader(string filename,uint blockSize = 1<<20) : base(true)
+    private int ReadFully(Span<byte> buffer)
     {
-        using var uName = new SafeStringBuffer(filename);
-        handle = archive_read_new();
-        archive_read_support_filter_all(handle);
-        archive_read_support_format_all(handle);
-        if (archive_read_open_filename(handle, uName.Ptr, (int)blockSize) != 0)
-            throw new ApplicationException("TODO: Archive open failed");
+        var filled = 0;
+        int r;
+        while (filled < buffer.Length && (r = ReadData(buffer[filled..])) > 0)
+            filled += r;
+        return filled;
     }
 
-    private void Throw()
+    private ArchiveResult TryReadFully(Span<byte> buffer, out int filled)
     {
-        throw new ApplicationException($"{Marshal.PtrToStringUTF8(archive_error_string(handle))}");
+        filled = 0;
+        int r;
+        while (filled < buffer.Length && (r = TryReadData(buffer[filled..])) != 0)
+        {
+            if (r < 0)
+            {
+                _source?.ThrowIfFailed();
+                return (ArchiveResult)r;
+            }
+            filled += r;
+        }
+        return ArchiveResult.Ok;
     }
 
-    protected override bool ReleaseHandle()
+    /// <summary>
+    /// Read the rest of the current entry into one array, sized from the header when it records the
+    /// size; grown from the pool only if it does not, or understates it
+    /// </summary>
+    /// <param name="size">Size from the header, or -1; less whatever has been read already</param>
+    /// <param name="pooled">Return an ArrayPool array, possibly longer than the data, rather than one of exactly length bytes</param>
+    /// <param name="length">Bytes of data in the array</param>
+    private byte[] ReadToEnd(long size, bool pooled, out int length)
     {
-        return archive_read_free(handle) == 0;
+        if (size > 0 && _readSerial == _serial)
+            size = Math.Max(size - _entryRead, 0);
+        if (size > Array.MaxLength)
+            throw new InvalidOperationException("The entry is too large for a single array");
+        var rented = size < 0 || pooled;
+        var buffer = size < 0 ? ArrayPool<byte>.Shared.Rent(1 << 16)
+            : pooled ? ArrayPool<byte>.Shared.Rent((int)size) : GC.AllocateUninitializedArray<byte>((int)size);
+        var limit = size < 0 ? buffer.Length : (int)size;
+        Span<byte> probe = stackalloc byte[1];
+        length = 0;
+        while (true)
+        {
+            length += ReadFully(buffer.AsSpan(length, limit - length));
+            if (length < limit || ReadData(probe) == 0)
+                break;
+            var larger = ArrayPool<byte>.Shared.Rent((int)Math.Min(Array.MaxLength, Math.Max(2L * buffer.Length, length + 1)));
+            buffer.AsSpan(0, length).CopyTo(larger);
+            larger[length++] = probe[0];
+            if (rented)
+                ArrayPool<byte>.Shared.Return(buffer);
+            buffer = larger;
+            rented = true;
+            limit = buffer.Length;
+        }
+
+        if (pooled || !rented && length == buffer.Length)
+            return buffer;
+        var exact = GC.AllocateUninitializedArray<byte>(length);
+        buffer.AsSpan(0, length).CopyTo(exact);
+        if (rented)
+            ArrayPool<byte>.Shared.Return(buffer);
+        return exact;
     }
 
-    public IEnumerable<Entry> Entries()
+    private Stream OpenSeekable(IntPtr entry, int windowSize)
+    {
+        const int ARCHIVE_FORMAT_BASE_MASK = unchecked((int)0xff0000);
+        const int ARCHIVE_FORMAT_CPIO = 0x10000;
+        const int ARCHIVE_FORMAT_TAR = 0x30000;
+        if (windowSize < 1)
+            throw new ArgumentOutOfRangeException(nameof(windowSize));
+        if (archive_entry_size_is_set(entry) == 0)
+            throw new NotSupportedException("The entry's size is not recorded in its header");
+        if (!CanReopen)
+            throw new InvalidOperationException("Seeking within entries needs a reader opened from a named file or from memory");
+
+        var name = Marshal.PtrToStringUTF8(archive_entry_pathname(entry))!;
+        var size = archive_entry_size(entry);
+        var ordinal = _ordinalBase + _serial - 1;
+        var format = archive_format(handle) & ARCHIVE_FORMAT_BASE_MASK;
+        // Unfiltered tar and cpio store file data as is, straight after the header, which is where
+        // libarchive has read up to until any of the data is read
+        if (archive_filter_code(handle, 0) == 0 && format is ARCHIVE_FORMAT_TAR or ARCHIVE_FORMAT_CPIO)
+        {
+            if ((archive_entry_filetype(entry) & AE_IFMT) == (uint)EntryType.File && archive_entry_sparse_count(entry) == 0 &&
+                _readSerial != _serial)
+            {
+                var data = archive_filter_bytes(handle, 0);
+                return _filename is not null
+                    ? new SeekableEntryStream(File.OpenHandle(_filename, options: FileOptions.RandomAccess), _baseOffset + data, size)
+                    : new SeekableEntryStream(_memory.Slice((int)data, (int)size));
+            }
+            return new SeekableEntryStream(this, name, ordinal, _baseOffset + archive_read_header_position(handle), format, size,
+                _readSerial == _serial, windowSize);
+        }
+
+        var offset = _index is not null && _index.TryGetLocation(name, out var indexed, out var at) && indexed == ordinal ? at : -1;
+        return new SeekableEntryStream(this, name, ordinal, offset, format, size, _readSerial == _serial, windowSize);
+    }
+
+    /// <summary>
+    /// Read every remaining header, skipping the data, for ArchiveIndex
+    /// </summary>
+    /// <param name="format">libarchive's base format code</param>
+    /// <param name="filtered">Whether the archive is compressed as a whole, so offsets in the file are meaningless</param>
+    internal unsafe List<(string? Name, long Position)> ScanHeaders(out int format, out bool filtered)
+    {
+        const int ARCHIVE_FORMAT_BASE_MASK = unchecked((int)0xff0000);
+        var headers = new List<(string?, long)>();
+        int r;
+        IntPtr entry;
+        while ((r=NextHeader(&entry))==0)
+        {
+            headers.Add((Marshal.PtrToStringUTF8(archive_entry_pathname(entry)), archive_read_header_position(handle)));
+            SkipData();
+        }
+
+        if (r != (int)ARCHIVE_RESULT.ARCHIVE_EOF)
+            Throw(r);
+        format = archive_format(handle) & ARCHIVE_FORMAT_BASE_MASK;
+        filtered = archive_filter_code(handle, 0) != 0;
+        return headers;
+    }
+
+    private static ArchiveEntryInfo Info(string name, IntPtr entry)
+    {
+        return new ArchiveEntryInfo(name,
+            archive_entry_size_is_set(entry) != 0 ? archive_entry_size(entry) : -1,
+            LastModified(entry),
+            (EntryType)(archive_entry_filetype(entry) & AE_IFMT),
+            (int)archive_entry_perm(entry) & 0xFFF,
+            Marshal.PtrToStringUTF8(archive_entry_hardlink(entry)),
+            Marshal.PtrToStringUTF8(archive_entry_symlink(entry)));
+    }
+
+    /// <summary>
+    /// Decompress the remaining entries on Scheduler, ahead of the consumer, so that CPU-heavy work
+    /// on the data (hashing, parsing) overlaps with decompression on another core. The producer
+    /// fills a ring of depth + 2 buffers and waits once depth chunks are queued, so memory use is
+    /// bounded; a chunk's buffer is only refilled after the consumer has read the chunk following it.
+    /// The reader must not be used otherwise until the channel completes, which it does with the
+    /// reader's exception on failure. Like Entries(), this consumes the reader.
+    /// </summary>
+    /// <param name="bufferSize">Bytes per chunk, default 1 MiB</param>
+    /// <param name="depth">Chunks decompressed ahead of the consumer, default 4</param>
+    /// <param name="cancellationToken">Stops the producer, completing the channel with OperationCanceledException; cancel to abandon the channel early</param>
+    /// <returns></returns>
+    public ChannelReader<ArchiveChunk> ReadPipelined(int bufferSize = 1<<20, int depth = 4, CancellationToken cancellationToken = default)
+    {
+        if (bufferSize < 1)
+            throw new ArgumentOutOfRangeException(nameof(bufferSize));
+        if (depth < 1)
+            throw new ArgumentOutOfRangeException(nameof(depth));
+        var channel = Channel.CreateBounded<ArchiveChunk>(new BoundedChannelOptions(depth)
+        {
+            SingleReader = true,
+            SingleWriter = true,
+            FullMode = BoundedChannelFullMode.Wait
+        });
+        var ring = new byte[depth + 2][];
+        for (var i = 0; i < ring.Length; i++)
+            ring[i] = GC.AllocateUninitializedArray<byte>(bufferSize);
+
+        var added = false;
+        DangerousAddRef(ref added);
+        Task.Factory.StartNew(() => Produce(channel.Writer, ring, cancellationToken), cancellationToken,
+                TaskCreationOptions.DenyChildAttach, Scheduler).Unwrap()
+            .ContinueWith((t, state) =>
+            {
+                ((LibArchiveReader)state!).DangerousRelease();
+                channel.Writer.TryComplete(t.IsCanceled ? new OperationCanceledException(cancellationToken) : t.Exception?.InnerException);
+            }, this, CancellationToken.None, TaskContinuationOptions.ExecuteSynchronously, TaskScheduler.Default);
+        return channel.Reader;
+    }
+
+    /// <summary>
+    /// Runs on Scheduler; its awaits resume there too, so native calls stay off the thread pool
+    /// </summary>
+    private async Task Produce(ChannelWriter<ArchiveChunk> writer, byte[][] ring, CancellationToken cancellationToken)
+    {
+        var next = 0;
+        var index = -1;
+        while (true)
+        {
+            var (info, found) = NextInfo(ref index);
+            if (!found)
+                return;
+            bool more;
+            do
+            {
+                cancellationToken.ThrowIfCancellationRequested();
+                var buffer = ring[next++ % ring.Length];
+                var filled = Fill(buffer, out more);
+                var chunk = new ArchiveChunk(index, info, buffer.AsMemory(0, filled), !more);
+                if (!writer.TryWrite(chunk))
+                    await writer.WriteAsync(chunk, cancellationToken);
+            } while (more);
+        }
+    }
+
+    private unsafe (ArchiveEntryInfo, bool) NextInfo(ref int index)
     {
         int r;
-        while ((r=archive_read_next_header(handle, out var entry))==0)
+        IntPtr entry;
+        while ((r=NextHeader(&entry))==0)
         {
+            index++;
             var name = Marshal.PtrToStringUTF8(archive_entry_pathname(entry));
             if (name is not null)
-                yield return new Entry(name, handle);
+                return (Info(name, entry), true);
+        }
+
+        if (r != (int)ARCHIVE_RESULT.ARCHIVE_EOF)
+            Throw(r);
+        return (default, false);
+    }
+
+    /// <summary>
+    /// Read the current entry's data until buffer is full or the entry ends
+    /// </summary>
+    private int Fill(byte[] buffer, out bool more)
+    {
+        var filled = ReadFully(buffer);
+        more = filled == buffer.Length;
+        return filled;
+    }
+
+    /// <summary>
+    /// Extract the remaining entries under directory entirely in native code: libarchive's disk
+    /// writer creates each file, directory and link and restores its metadata, and data goes from
+    /// the decoder to the file without passing through managed buffers or extra P/Invoke calls.
+    /// Like Entries(), this consumes the reader.
+    /// </summary>
+    /// <param name="directory">Target directory, created if need be</param>
+    /// <param name="options">What to restore and how to treat paths, default ExtractOptions.Default</param>
+    /// <param name="cancellationToken">Checked before each entry</param>
+    /// <exception cref="ArchiveException">An entry could not be extracted, or was refused by SecurePaths</exception>
+    public unsafe void ExtractTo(string directory, ExtractOptions? options = null, CancellationToken cancellationToken = default)
+    {
+        options ??= ExtractOptions.Default;
+        Directory.CreateDirectory(directory);
+        var root = Encoding.UTF8.GetBytes(ResolveLinks(Path.GetFullPath(directory)) + Path.DirectorySeparatorChar);
+        var path = new byte[root.Length + 256];
+        var raw = new byte[root.Length + 256];
+        root.CopyTo(path, 0);
+        root.CopyTo(raw, 0);
+        var preallocate = options.Preallocate && !OperatingSystem.IsWindows();
+
+        using var lease = new Lease(this);
+        var disk = archive_write_disk_new();
+        try
+        {
+            archive_write_disk_set_options(disk, options.Flags);
+            if (options.Owner)
+                archive_write_disk_set_standard_lookup(disk);
+
+            int r;
+            IntPtr entry;
+            while ((r=NextHeader(&entry))==0)
+            {
+                cancellationToken.ThrowIfCancellationRequested();
+                if (!Reroot(entry, ref path, ref raw, root.Length, false))
+                    continue;
+                var link = Reroot(entry, ref path, ref raw, root.Length, true);
+
+                if (!preallocate || link || archive_entry_size(entry) <= 0 ||
+                    (archive_entry_filetype(entry) & AE_IFMT) != (uint)EntryType.File ||
+                    !TryExtractPreallocated(disk, entry, options.Overwrite))
+                {
+                    var size = archive_entry_size(entry);
+                    var start = Stopwatch.GetTimestamp();
+                    var result = archive_read_extract2(handle, entry, disk);
+                    _dataTicks += Stopwatch.GetTimestamp() - start;
+                    Check(result);
+                    _uncompressed += size;
+                }
+            }
+
+            if (r != (int)ARCHIVE_RESULT.ARCHIVE_EOF)
+                Throw(r);
+            // Applies the permissions and times of directories, deferred until their contents are written
+            Check(disk, archive_write_close(disk));
+        }
+        finally
+        {
+            archive_write_free(disk);
+        }
+    }
+
+    /// <summary>
+    /// Let the disk writer create the file and restore its metadata, but write the data through a
+    /// handle of our own opened with the full size preallocated, which libarchive has no option for
+    /// </summary>
+    /// <returns>False, with nothing done, if the entry is left to archive_read_extract2 instead</returns>
+    private bool TryExtractPreallocated(IntPtr disk, IntPtr entry, bool overwrite)
+    {
+        var utf8 = archive_entry_pathname_utf8(entry);
+        var path = Marshal.PtrToStringUTF8(utf8 != IntPtr.Zero ? utf8 : archive_entry_pathname(entry))!;
+        // Under NO_OVERWRITE the disk writer leaves an existing file alone yet reports success, and
+        // opening it here would truncate it
+        if (!overwrite && (File.Exists(path) || Directory.Exists(path)))
+            return false;
+        Check(disk, archive_write_header(disk, entry));
+        var size = archive_entry_size(entry);
+        using (var file = File.OpenHandle(path, FileMode.Create, FileAccess.Write, FileShare.ReadWrite, FileOptions.None, size))
+        {
+            var start = Stopwatch.GetTimestamp();
+            var r = archive_read_data_into_fd(handle, (int)file.DangerousGetHandle());
+            _dataTicks += Stopwatch.GetTimestamp() - start;
+            Check(r);
+        }
+        _uncompressed += size;
+        Check(disk, archive_write_finish_entry(disk));
+        return true;
+    }
+
+    /// <summary>
+    /// Put the entry's path, or its hardlink target, under the root already in path and raw. The root
+    /// is UTF-8, so the path is read and set as UTF-8 where libarchive can convert it to and from the
+    /// locale's encoding. Where it cannot, e.g. a non-ASCII name under the C locale, the archive's own
+    /// bytes are passed through after the root, as POSIX filesystems take them.
+    /// </summary>
+    /// <returns>False if the entry has no such path</returns>
+    private static unsafe bool Reroot(IntPtr entry, ref byte[] path, ref byte[] raw, int rootLength, bool link)
+    {
+        // Copied first, as a failed UTF-8 update clears the entry's other forms of the path
+        var bytes = link ? archive_entry_hardlink(entry) : archive_entry_pathname(entry);
+        if (bytes != IntPtr.Zero)
+            Rooted(ref raw, rootLength, bytes);
+        var utf8 = link ? archive_entry_hardlink_utf8(entry) : archive_entry_pathname_utf8(entry);
+        if (utf8 != IntPtr.Zero)
+        {
+            Rooted(ref path, rootLength, utf8);
+            fixed (byte* p = path)
+                if ((link ? archive_entry_update_hardlink_utf8(entry, p) : archive_entry_update_pathname_utf8(entry, p)) != 0)
+                    return true;
+        }
+        if (bytes == IntPtr.Zero)
+            return false;
+        fixed (byte* p = raw)
+            if (link)
+                archive_entry_set_hardlink(entry, p);
+            else
+                archive_entry_set_pathname(entry, p);
+        return true;
+    }
+
+    /// <summary>
+    /// Append a null-terminated entry path, less any leading '/', to the root already in buffer
+    /// </summary>
+    private static unsafe void Rooted(ref byte[] buffer, int rootLength, IntPtr name)
+    {
+        var relative = MemoryMarshal.CreateReadOnlySpanFromNullTerminated((byte*)name).TrimStart((byte)'/');
+        var length = rootLength + relative.Length + 1;
+        if (buffer.Length < length)
+            Array.Resize(ref buffer, length * 2);
+        relative.CopyTo(buffer.AsSpan(rootLength));
+        buffer[length - 1] = 0;
+    }
+
+    /// <summary>
+    /// Replace symlinked components of an absolute directory path with their targets, as
+    /// SECURE_SYMLINKS refuses links anywhere in the path, including above the target directory
+    /// </summary>
+    private static string ResolveLinks(string directory)
+    {
+        var resolved = Path.GetPathRoot(directory)!;
+        foreach (var part in directory[resolved.Length..].Split(Path.DirectorySeparatorChar, StringSplitOptions.RemoveEmptyEntries))
+        {
+            resolved = Path.Combine(resolved, part);
+            if (new DirectoryInfo(resolved).ResolveLinkTarget(true) is { } target)
+                resolved = target.FullName;
+        }
+        return Path.TrimEndingDirectorySeparator(resolved);
+    }
+
+    private static DateTimeOffset? LastModified(IntPtr entry)
+    {
+        if (archive_entry_mtime_is_set(entry) == 0)
+            return null;
+        return DateTimeOffset.FromUnixTimeSeconds(archive_entry_mtime(entry)).AddTicks(archive_entry_mtime_nsec(entry) / 100);
+    }
+
+    /// <summary>
+    /// The next header, as archive_read_next_header, but with whatever the ErrorPolicy lets pass
+    /// turned into ARCHIVE_OK or a read of the header after
+    /// </summary>
+    private unsafe int NextHeader(IntPtr* entry)
+    {
+        while (true)
+        {
+            var r = ReadHeader(entry);
+            if (r is (int)ARCHIVE_RESULT.ARCHIVE_OK or (int)ARCHIVE_RESULT.ARCHIVE_EOF)
+                return r;
+            if (r == (int)ARCHIVE_RESULT.ARCHIVE_WARN && Passes(r))
+                return (int)ARCHIVE_RESULT.ARCHIVE_OK;
+            if (r == (int)ARCHIVE_RESULT.ARCHIVE_RETRY && Passes(r))
+                continue;
+            if (r == (int)ARCHIVE_RESULT.ARCHIVE_FAILED && Policy == ErrorPolicy.SkipFailedEntries)
+            {
+                _warnings++;
+                continue;
+            }
+            return r;
+        }
+    }
+
+    /// <summary>
+    /// archive_read_next_header. Moves the serial on even at the end of the archive, as libarchive
+    /// clears the previous entry either way.
+    /// </summary>
+    private unsafe int ReadHeader(IntPtr* entry)
+    {
+        using var lease = new Lease(this);
+        _serial++;
+        var start = Stopwatch.GetTimestamp();
+        var r = archive_read_next_header(handle, entry);
+        _headerTicks += Stopwatch.GetTimestamp() - start;
+        if (r is (int)ARCHIVE_RESULT.ARCHIVE_OK or (int)ARCHIVE_RESULT.ARCHIVE_WARN)
+            _headers++;
+        return r;
+    }
+
+    /// <summary>
+    /// A reference on the handle held across a native call, so that Dispose on another thread
+    /// defers archive_read_free until the call returns rather than freeing memory still in use.
+    /// Taking one throws ObjectDisposedException once the reader is disposed.
+    /// </summary>
+    private readonly ref struct Lease
+    {
+        private readonly LibArchiveReader _reader;
+
+        public Lease(LibArchiveReader reader)
+        {
+            var added = false;
+            reader.DangerousAddRef(ref added);
+            _reader = reader;
+        }
+
+        public void Dispose() => _reader.DangerousRelease();
+    }
+
+    private void SkipData()
+    {
+        using var lease = new Lease(this);
+        var start = Stopwatch.GetTimestamp();
+        var r = archive_read_data_skip(handle);
+        _headerTicks += Stopwatch.GetTimestamp() - start;
+        Check(r);
+    }
+
+    private unsafe Entry? NextEntry(PathFilter? pathFilter = null, EntryFilter? entryFilter = null, bool reuse = false)
+    {
+        int r;
+        IntPtr entry;
+        while ((r=NextHeader(&entry))==0)
+        {
+            var path = archive_entry_pathname(entry);
+            if (path == IntPtr.Zero)
+                continue;
+            if ((pathFilter is null || pathFilter(MemoryMarshal.CreateReadOnlySpanFromNullTerminated((byte*)path))) &&
+                (entryFilter is null || !entryFilter.Excludes(entry)))
+            {
+                if (!reuse)
+                    return new Entry(this, entry);
+                if (_reused is null)
+                    _reused = new Entry(this, entry);
+                else
+                    _reused.Reset(entry);
+                return _reused;
+            }
+            SkipData();
         }
 
         if (r != (int)ARCHIVE_RESULT.ARCHIVE_EOF)
-            Throw();
+            Throw(r);
+        return null;
+    }
+
+    private Task<T> RunNative<T>(Func<T> call, CancellationToken cancellationToken)
+    {
+        return Task.Factory.StartNew(call, cancellationToken, TaskCreationOptions.DenyChildAttach, Scheduler);
     }
 
+    /// <summary>
+    /// The entry whose header was most recently read. Metadata is read from libarchive on demand, so
+    /// an Entry is only usable until the reader moves to the next header; after that, anything not
+    /// already fetched throws InvalidOperationException.
+    /// </summary>
     public class Entry
     {
-        public string Name { get; }
-        private readonly IntPtr handle;
-        public FileStream Stream => new FileStream(handle);
+        private readonly LibArchiveReader reader;
+        private IntPtr entry;
+        private int serial;
+        private string? name;
+        private FileStream? stream;
+        private int streamSerial;
+
+        internal Entry(LibArchiveReader reader, IntPtr entry)
+        {
+            this.reader = reader;
+            this.entry = entry;
+            this.serial = reader._serial;
+        }
+
+        /// <summary>
+        /// Point this Entry at the header just read, for ReuseEntries
+        /// </summary>
+        internal void Reset(IntPtr current)
+        {
+            entry = current;
+            serial = reader._serial;
+            name = null;
+        }
+
+        private IntPtr Current => reader.IsClosed
+            ? throw new ObjectDisposedException(nameof(LibArchiveReader))
+            : serial == reader._serial
+                ? entry
+                : throw new InvalidOperationException("The reader has moved past this entry");
+
+        /// <summary>
+        /// Path within the archive, decoded and cached on first use
+        /// </summary>
+        public string Name => name ??= Marshal.PtrToStringUTF8(archive_entry_pathname(Current))!;
+
+        /// <summary>
+        /// Raw UTF-8 path within the archive, without allocating a string. Only valid until the
+        /// reader moves to the next header.
+        /// </summary>
+        public unsafe ReadOnlySpan<byte> PathUtf8 => MemoryMarshal.CreateReadOnlySpanFromNullTerminated((byte*)archive_entry_pathname(Current));
+
+        /// <summary>
+        /// Uncompressed size in bytes; 0 if the header does not record it (see SizeIsSet)
+        /// </summary>
+        public long Size => archive_entry_size(Current);
+
+        /// <summary>
+        /// Whether the header records the size, as some streaming formats only learn it at the end of the data
+        /// </summary>
+        public bool SizeIsSet => archive_entry_size_is_set(Current) != 0;
+
+        /// <summary>
+        /// Modification time, or null if the header does not record it
+        /// </summary>
+        public DateTimeOffset? LastModified => LibArchiveReader.LastModified(Current);
+
+        public EntryType Type => (EntryType)(archive_entry_filetype(Current) & AE_IFMT);
+
+        /// <summary>
+        /// Permission bits (the low 12 bits of the Unix mode)
+        /// </summary>
+        public int Permissions => (int)archive_entry_perm(Current) & 0xFFF;
+
+        public string? HardlinkTarget => Marshal.PtrToStringUTF8(archive_entry_hardlink(Current));
+        public string? SymlinkTarget => Marshal.PtrToStringUTF8(archive_entry_symlink(Current));
+
+        /// <summary>
+        /// The entry's data. Every access returns the same FileStream, and under ReuseEntries that
+        /// stream is reset and returned again for the following entries.
+        /// </summary>
+        public FileStream Stream
+        {
+            get
+            {
+                var current = Current;
+                if (stream is null || streamSerial != serial)
+                {
+                    var length = archive_entry_size_is_set(current) != 0 ? archive_entry_size(current) : -1;
+                    if (stream is null)
+                        stream = new FileStream(reader, length);
+                    else
+                        stream.Reset(length);
+                    streamSerial = serial;
+                }
+                return stream;
+            }
+        }
+
+        /// <summary>
+        /// Enumerate the entry's data as libarchive's own decompressed blocks, without copying them.
+        /// Each block is only valid until the next one is requested. Do not mix with reads from Stream
+        /// on the same entry.
+        /// </summary>
+        /// <returns></returns>
+        public BlockEnumerator ReadBlocks()
+        {
+            _ = Current;
+            return new BlockEnumerator(reader);
+        }
+
+        /// <summary>
+        /// Open the entry's data as a seekable Stream, which stays usable after the reader moves on or is
+        /// disposed. Files stored as is in an uncompressed tar or cpio archive are read straight from the
+        /// archive at any position, unless some of the data has already been read. Otherwise the data is
+        /// decompressed forwards, keeping the last windowSize bytes for backward seeks; seeking back
+        /// further than that reopens the entry, from its header when the offset is known (zip with an
+        /// Index, tar and cpio) or else from the start of the archive, and decompresses forwards again.
+        /// The reader must have been opened from a named file or from memory, and the header must record
+        /// the size.
+        /// </summary>
+        /// <param name="windowSize">Bytes of recently decompressed data kept for backward seeks, default 4 MiB</param>
+        /// <returns></returns>
+        /// <exception cref="NotSupportedException">The entry's size is not known</exception>
+        /// <exception cref="InvalidOperationException">The reader was opened from a Stream, so cannot reopen the entry</exception>
+        public Stream OpenSeekable(int windowSize = 4<<20)
+        {
+            return reader.OpenSeekable(Current, windowSize);
+        }
+
+        /// <summary>
+        /// Read the entry's remaining data into a new array. When the header records the size, the
+        /// array is allocated once at exactly that size and filled in place.
+        /// </summary>
+        /// <returns></returns>
+        /// <exception cref="InvalidOperationException">The entry is too large for one array</exception>
+        public byte[] ReadAllBytes()
+        {
+            var current = Current;
+            return reader.ReadToEnd(archive_entry_size_is_set(current) != 0 ? archive_entry_size(current) : -1, false, out _);
+        }
+
+        /// <summary>
+        /// Hash the entry's remaining data as it is decompressed: each of libarchive's blocks goes
+        /// straight to an IncrementalHash, with no intermediate buffer or Stream. Holes in sparse
+        /// files hash as the zeros they read as.
+        /// </summary>
+        /// <param name="algorithm">e.g. HashAlgorithmName.SHA256</param>
+        /// <returns></returns>
+        /// <exception cref="CryptographicException">algorithm is not supported</exception>
+        public byte[] ComputeHash(HashAlgorithmName algorithm)
+        {
+            _ = Current;
+            using var hash = IncrementalHash.CreateHash(algorithm);
+            reader.AppendData(hash);
+            return hash.GetHashAndReset();
+        }
+
+        /// <summary>
+        /// Append the entry's remaining data to hash without finishing it, e.g. to reuse one
+        /// IncrementalHash for every entry through GetHashAndReset, or to compute an HMAC
+        /// </summary>
+        /// <param name="hash"></param>
+        public void AppendTo(IncrementalHash hash)
+        {
+            if (hash is null)
+                throw new ArgumentNullException(nameof(hash));
+            _ = Current;
+            reader.AppendData(hash);
+        }
+
+        /// <summary>
+        /// Read the entry's remaining data into an ArrayPool buffer, returned to the pool when the
+        /// owner is disposed; Memory is exactly the length of the data
+        /// </summary>
+        /// <returns></returns>
+        /// <exception cref="InvalidOperationException">The entry is too large for one array</exception>
+        public IMemoryOwner<byte> ReadPooled()
+        {
+            var current = Current;
+            var buffer = reader.ReadToEnd(archive_entry_size_is_set(current) != 0 ? archive_entry_size(current) : -1, true, out var length);
+            return new PooledMemory(buffer, length);
+        }
+
+        /// <summary>
+        /// Read the entry's data into destination until it is full or the entry ends; whatever does not
+        /// fit is left to be read
+        /// </summary>
+        /// <param name="destination"></param>
+        /// <returns>Number of bytes read</returns>
+        public int ReadInto(Span<byte> destination)
+        {
+            _ = Current;
+            return reader.ReadFully(destination);
+        }
+
+        /// <summary>
+        /// As ReadInto, but report a failure as a status code rather than throwing. The ErrorPolicy
+        /// does not apply.
+        /// </summary>
+        /// <param name="destination"></param>
+        /// <param name="read">Bytes read before the end of the data or the failure</param>
+        /// <returns>Ok, or what libarchive reported (reader.ErrorMessage says why)</returns>
+        public ArchiveResult TryReadInto(Span<byte> destination, out int read)
+        {
+            _ = Current;
+            return reader.TryReadFully(destination, out read);
+        }
+    }
+
+    /// <summary>
+    /// A view of one block of entry data inside libarchive's buffer. Offset is the position of the
+    /// block within the entry; a gap between the end of one block and the Offset of the next is a
+    /// sparse hole of zeros which is never materialised.
+    /// </summary>
+    public readonly ref struct DataBlock
+    {
+        public ReadOnlySpan<byte> Data { get; }
+        public long Offset { get; }
+
+        internal DataBlock(ReadOnlySpan<byte> data, long offset)
+        {
+            Data = data;
+            Offset = offset;
+        }
+    }
+
+    /// <summary>
+    /// Enumerator over archive_read_data_block for the current entry. A trailing hole is reported
+    /// as a final empty block at the entry's logical end.
+    /// </summary>
+    public ref struct BlockEnumerator
+    {
+        private readonly LibArchiveReader _archive;
+        private long _end;
+        private bool _done;
+
+        internal BlockEnumerator(LibArchiveReader archive)
+        {
+            _archive = archive;
+            _end = 0;
+            _done = false;
+            Current = default;
+        }
+
+        public BlockEnumerator GetEnumerator() => this;
+
+        public DataBlock Current { get; private set; }
+
+        public unsafe bool MoveNext()
+        {
+            if (_done)
+                return false;
+            IntPtr buff;
+            nuint size;
+            long offset;
+            int r;
+            using var lease = new Lease(_archive);
+            _archive.StartData();
+            // A retry has no block to return, but a warning comes with a good one
+            do
+            {
+                var start = Stopwatch.GetTimestamp();
+                r = archive_read_data_block(_archive.handle, &buff, &size, &offset);
+                _archive._dataTicks += Stopwatch.GetTimestamp() - start;
+            } while (r == (int)ARCHIVE_RESULT.ARCHIVE_RETRY && _archive.Passes(r));
+            if (r == (int)ARCHIVE_RESULT.ARCHIVE_EOF)
+            {
+                _done = true;
+                if (offset <= _end)
+                    return false;
+                Current = new DataBlock(ReadOnlySpan<byte>.Empty, offset);
+                _archive._uncompressed += offset - _end;
+                _end = offset;
+                return true;
+            }
+            if (r != (int)ARCHIVE_RESULT.ARCHIVE_OK && (r != (int)ARCHIVE_RESULT.ARCHIVE_WARN || !_archive.Passes(r)))
+                _archive.Throw(r);
+            Current = new DataBlock(new ReadOnlySpan<byte>((void*)buff, checked((int)size)), offset);
+            // Holes count as data produced, as they do through ReadData
+            _archive._uncompressed += offset + (long)size - _end;
+            _end = offset + (long)size;
+            return true;
+        }
+    }
+
+    /// <summary>
+    /// Enumerates entries through one reused Entry; see ReuseEntries
+    /// </summary>
+    public ref struct EntryEnumerator
+    {
+        private readonly LibArchiveReader _archive;
+        private readonly PathFilter? _filter;
+
+        internal EntryEnumerator(LibArchiveReader archive, PathFilter? filter)
+        {
+            _archive = archive;
+            _filter = filter;
+            Current = null!;
+        }
 
-        internal Entry(string name, IntPtr handle)
+        public EntryEnumerator GetEnumerator() => this;
+
+        public Entry Current { get; private set; }
+
+        public bool MoveNext()
         {
-            this.Name = name;
-            this.handle = handle;
+            if (_archive.NextEntry(_filter, null, true) is not { } entry)
+                return false;
+            Current = entry;
+            return true;
         }
     }
 
     public class FileStream : Stream
     {
-        private readonly IntPtr _archive;
-        internal FileStream(IntPtr archive)
+        private readonly LibArchiveReader _archive;
+        private long _length;
+        private long _position;
+        private int _serial;
+
+        internal FileStream(LibArchiveReader archive, long length)
         {
             this._archive = archive;
+            _length = length;
+            _serial = archive._serial;
+        }
+
+        /// <summary>
+        /// Start over on the next entry, whose size is length or -1 if not recorded
+        /// </summary>
+        internal void Reset(long length)
+        {
+            _length = length;
+            _position = 0;
+            _serial = _archive._serial;
         }
         
         public override void Flush()
@@ -106,7 +1617,93 @@ public class LibArchiveReader : SafeHandleZeroOrMinusOneIsInvalid
 
         public override int Read(byte[] buffer, int offset, int count)
         {
-            return archive_read_data(_archive, ref MemoryMarshal.GetReference(buffer.AsSpan()[offset..]), count);
+            return Read(buffer.AsSpan(offset, count));
+        }
+
+        /// <summary>
+        /// Decompress directly into the caller's buffer, bypassing the base Stream rent-and-copy fallback
+        /// </summary>
+        /// <param name="buffer"></param>
+        /// <returns>Number of bytes read, 0 at the end of the entry or once the reader has moved past it</returns>
+        public override int Read(Span<byte> buffer)
+        {
+            if (_serial != _archive._serial)
+                return 0;
+            return _archive.ReadData(buffer);
+        }
+
+        public override Task<int> ReadAsync(byte[] buffer, int offset, int count, CancellationToken cancellationToken)
+        {
+            return ReadAsync(buffer.AsMemory(offset, count), cancellationToken).AsTask();
+        }
+
+        /// <summary>
+        /// Decompress directly into the caller's memory on the reader's Scheduler. Large reads are
+        /// split into chunks with cancellation checked between them; if cancelled part-way, the bytes
+        /// already decompressed are returned.
+        /// </summary>
+        public override ValueTask<int> ReadAsync(Memory<byte> buffer, CancellationToken cancellationToken = default)
+        {
+            const int chunk = 1 << 20;
+            if (cancellationToken.IsCancellationRequested)
+                return ValueTask.FromCanceled<int>(cancellationToken);
+            return new ValueTask<int>(_archive.RunNative(() =>
+            {
+                var total = 0;
+                while (total < buffer.Length)
+                {
+                    if (cancellationToken.IsCancellationRequested)
+                    {
+                        if (total > 0)
+                            break;
+                        cancellationToken.ThrowIfCancellationRequested();
+                    }
+                    var r = Read(buffer.Span.Slice(total, Math.Min(chunk, buffer.Length - total)));
+                    if (r == 0)
+                        break;
+                    total += r;
+                }
+                return total;
+            }, cancellationToken));
+        }
+
+        /// <summary>
+        /// Copy the remainder of the entry to destination. If none of its data has been read yet, by
+        /// this stream or any other means, libarchive's blocks are written out directly with no
+        /// intermediate buffer; otherwise a single pooled buffer is used for the whole copy.
+        /// </summary>
+        /// <param name="destination"></param>
+        /// <param name="bufferSize"></param>
+        public override void CopyTo(Stream destination, int bufferSize)
+        {
+            if (_serial != _archive._serial)
+                return;
+            // archive_read_data_block cannot take over part-way through what archive_read_data has begun
+            if (_archive._readSerial != _archive._serial)
+            {
+                long end = 0;
+                foreach (var block in new BlockEnumerator(_archive))
+                {
+                    for (var hole = block.Offset - end; hole > 0; hole -= Zeros.Length)
+                        destination.Write(Zeros, 0, (int)Math.Min(hole, Zeros.Length));
+                    destination.Write(block.Data);
+                    end = block.Offset + block.Data.Length;
+                }
+                _position = end;
+                return;
+            }
+
+            var buffer = ArrayPool<byte>.Shared.Rent(bufferSize);
+            try
+            {
+                int r;
+                while ((r = Read(buffer)) > 0)
+                    destination.Write(buffer, 0, r);
+            }
+            finally
+            {
+                ArrayPool<byte>.Shared.Return(buffer);
+            }
         }
 
         public override long Seek(long offset, SeekOrigin origin)
@@ -127,38 +1724,20 @@ public class LibArchiveReader : SafeHandleZeroOrMinusOneIsInvalid
         public override bool CanRead => true;
         public override bool CanSeek => false;
         public override bool CanWrite => false;
-        public override long Length => throw new NotSupportedException();
+        /// <summary>
+        /// The size recorded in the entry's header, even though the stream cannot seek
+        /// </summary>
+        /// <exception cref="NotSupportedException">The header does not record the size</exception>
+        public override long Length => _length >= 0 ? _length : throw new NotSupportedException("The entry's size is not recorded in its header");
+
+        /// <summary>
+        /// Bytes of the entry read so far, through this stream or the Entry's own read methods; cannot be set
+        /// </summary>
         public override long Position
         {
-            get => throw new NotSupportedException();
+            // _position only counts what CopyTo took as libarchive's blocks
+            get => _archive._readSerial == _serial ? _archive._entryRead : _position;
             set => throw new NotSupportedException();
         }
     }
-
-    [DllImport("archive")]
-    private static extern IntPtr archive_read_new();
-
-    [DllImport("archive")]
-    private static extern void archive_read_support_filter_all(IntPtr a);
-    
-    [DllImport("archive")]
-    private static extern void archive_read_support_format_all(IntPtr a);
-
-    [DllImport("archive")]
-    private static extern int archive_read_open_filename(IntPtr a, IntPtr filename, int blocksize);
-
-    [DllImport("archive")]
-    private static extern int archive_read_data(IntPtr a, ref byte buff, int size);
-
-    [DllImport("archive")]
-    private static extern int archive_read_next_header(IntPtr a, out IntPtr entry);
-
-    [DllImport("archive")]
-    private static extern IntPtr archive_entry_pathname(IntPtr entry);
-
-    [DllImport("archive")]
-    private static extern int archive_read_free(IntPtr a);
-
-    [DllImport("archive")]
-    private static extern IntPtr archive_error_string(IntPtr a);
 }
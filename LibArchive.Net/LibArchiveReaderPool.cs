@@ -0,0 +1,176 @@
+using System;
+using System.Collections.Concurrent;
+using System.IO;
+using System.Threading;
+using static LibArchive.Net.Native;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// Open many small archives of a known kind at a lower cost each. libarchive cannot reopen a read
+/// handle once it has been closed, so handles themselves are not recycled; instead the pool keeps a
+/// stock of fresh handles with the formats, filters and options already applied, topped up on a
+/// thread-pool thread rather than the caller's, and reuses the pinned read buffers of Stream
+/// sources. Thread safe.
+/// </summary>
+public sealed class LibArchiveReaderPool : IDisposable
+{
+    private const int ARCHIVE_OK = 0;
+
+    private readonly ReaderOptions _options;
+    private readonly uint _blockSize;
+    private readonly ConcurrentQueue<IntPtr> _handles = new();
+    private readonly ConcurrentBag<byte[]> _buffers = new();
+    private int _refilling;
+    private volatile bool _disposed;
+
+    /// <summary>
+    /// Number of configured handles and of read buffers kept in stock
+    /// </summary>
+    public int Retain { get; }
+
+    /// <summary>
+    /// Create the pool and its initial stock of handles
+    /// </summary>
+    /// <param name="options">Formats, filters and options for every reader, default all formats and filters</param>
+    /// <param name="blockSize">Block size in bytes, default 1 MiB</param>
+    /// <param name="retain">Handles and buffers to keep in stock, default two per core</param>
+    /// <exception cref="ArchiveException">options are not accepted by libarchive</exception>
+    public LibArchiveReaderPool(ReaderOptions? options = null, uint blockSize = 1<<20, int retain = 0)
+    {
+        if (retain < 0)
+            throw new ArgumentOutOfRangeException(nameof(retain));
+        _options = options ?? ReaderOptions.Default;
+        _blockSize = blockSize;
+        Retain = retain == 0 ? 2 * Environment.ProcessorCount : retain;
+        for (var i = 0; i < Retain; i++)
+            _handles.Enqueue(Create());
+    }
+
+    /// <summary>
+    /// Open the named archive
+    /// </summary>
+    /// <param name="filename"></param>
+    /// <exception cref="ArchiveException"></exception>
+    public LibArchiveReader Open(string filename)
+    {
+        var reader = Rent();
+        try
+        {
+            reader.OpenFile(filename, _blockSize);
+            return reader;
+        }
+        catch
+        {
+            reader.Dispose();
+            throw;
+        }
+    }
+
+    /// <summary>
+    /// Open an archive read from a Stream, through one of the pool's buffers
+    /// </summary>
+    /// <param name="stream"></param>
+    /// <param name="leaveOpen">Leave the stream open when the reader is disposed</param>
+    /// <exception cref="ArchiveException"></exception>
+    public LibArchiveReader Open(Stream stream, bool leaveOpen = false)
+    {
+        if (stream is null)
+            throw new ArgumentNullException(nameof(stream));
+        var buffer = _buffers.TryTake(out var b) ? b : GC.AllocateUninitializedArray<byte>((int)_blockSize, pinned: true);
+        var source = new StreamSource(stream, buffer, leaveOpen);
+        var reader = Rent();
+        try
+        {
+            reader.OpenSource(source);
+            return reader;
+        }
+        catch
+        {
+            reader.Dispose();
+            throw;
+        }
+    }
+
+    /// <summary>
+    /// Open an archive already resident in memory, which must not be modified until the reader is disposed
+    /// </summary>
+    /// <param name="archive"></param>
+    /// <exception cref="ArchiveException"></exception>
+    public LibArchiveReader Open(ReadOnlyMemory<byte> archive)
+    {
+        var reader = Rent();
+        try
+        {
+            reader.OpenMemory(archive);
+            return reader;
+        }
+        catch
+        {
+            reader.Dispose();
+            throw;
+        }
+    }
+
+    private LibArchiveReader Rent()
+    {
+        if (_disposed)
+            throw new ObjectDisposedException(nameof(LibArchiveReaderPool));
+        if (!_handles.TryDequeue(out var handle))
+            handle = Create();
+        if (_handles.Count < Retain / 2 && Interlocked.Exchange(ref _refilling, 1) == 0)
+            ThreadPool.UnsafeQueueUserWorkItem(static pool => pool.Refill(), this, false);
+        return new LibArchiveReader(handle, this, _options);
+    }
+
+    private IntPtr Create()
+    {
+        var handle = archive_read_new();
+        var r = _options.Apply(handle);
+        if (r == ARCHIVE_OK)
+            return handle;
+        var error = ArchiveException.From(handle, r, "Invalid reader options");
+        archive_read_free(handle);
+        throw error;
+    }
+
+    private void Refill()
+    {
+        try
+        {
+            while (!_disposed && _handles.Count < Retain)
+                _handles.Enqueue(Create());
+        }
+        finally
+        {
+            Volatile.Write(ref _refilling, 0);
+        }
+        if (_disposed)
+            FreeHandles();
+    }
+
+    /// <summary>
+    /// Take back the read buffer of a disposed reader
+    /// </summary>
+    internal void Return(byte[] buffer)
+    {
+        if (!_disposed && buffer.Length == _blockSize && _buffers.Count < Retain)
+            _buffers.Add(buffer);
+    }
+
+    private void FreeHandles()
+    {
+        while (_handles.TryDequeue(out var handle))
+            archive_read_free(handle);
+    }
+
+    /// <summary>
+    /// Free the stock of handles and buffers; readers already handed out stay usable
+    /// </summary>
+    public void Dispose()
+    {
+        _disposed = true;
+        FreeHandles();
+        _buffers.Clear();
+    }
+}
@@ -0,0 +1,32 @@
+using System;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// The native libarchive library behind every reader and writer
+/// </summary>
+public static class LibArchiveRuntime
+{
+    /// <summary>
+    /// Load libarchive and call into it, so finding, mapping and binding the library happens during
+    /// application startup rather than when the first archive is opened
+    /// </summary>
+    /// <returns>libarchive's version number, e.g. 3006002 for 3.6.2</returns>
+    /// <exception cref="DllNotFoundException">Neither a bundled nor a system libarchive could be loaded</exception>
+    public static int Preload()
+    {
+        var version = Native.archive_version_number();
+        // Bind and page in the entry points behind opening any archive
+        var a = Native.archive_read_new();
+        Native.archive_read_support_filter_all(a);
+        Native.archive_read_support_format_all(a);
+        Native.archive_read_free(a);
+        return version;
+    }
+
+    /// <summary>
+    /// The file libarchive was loaded from: null until it is loaded, or if no bundled library was
+    /// found and the runtime's default search supplied one
+    /// </summary>
+    public static string? LibraryPath => Native.LibraryPath;
+}
@@ -0,0 +1,243 @@
+using System;
+using System.Buffers;
+using System.IO;
+using System.Text;
+using Microsoft.Win32.SafeHandles;
+using static LibArchive.Net.Native;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// Create an archive, one entry at a time. Entry data is handed to libarchive straight from the
+/// caller's span, or through one pooled buffer for Stream sources, and compressed output is written
+/// to the sink straight from libarchive's buffer. Not thread safe; zstd and xz can still compress on
+/// several threads internally when asked to via the threads option.
+/// </summary>
+public class LibArchiveWriter : SafeHandleZeroOrMinusOneIsInvalid
+{
+    private const int ARCHIVE_WARN = -20;
+    private const uint AE_IFREG = 0x8000;
+    private const uint AE_IFDIR = 0x4000;
+
+    private readonly IntPtr _entry;
+    private readonly int _blockSize;
+    private StreamSink? _sink;
+
+    private LibArchiveWriter(ArchiveFormat format, ArchiveFilter filter, int compressionLevel, int threads, string? options, uint blockSize) : base(true)
+    {
+        handle = archive_write_new();
+        _entry = archive_entry_new();
+        _blockSize = (int)blockSize;
+        Check(Set(archive_write_set_format_by_name, FormatName(format)));
+        if (filter != ArchiveFilter.None)
+            Check(Set(archive_write_add_filter_by_name, filter.ToString().ToLowerInvariant()));
+
+        var all = new StringBuilder();
+        if (compressionLevel >= 0)
+            all.Append("compression-level=").Append(compressionLevel);
+        if (threads > 0)
+            all.Append(all.Length > 0 ? "," : "").Append("threads=").Append(threads);
+        if (!string.IsNullOrEmpty(options))
+            all.Append(all.Length > 0 ? "," : "").Append(options);
+        if (all.Length > 0)
+            Check(Set(archive_write_set_options, all.ToString()));
+
+        // Compressed output is never padded out to a whole block
+        Check(archive_write_set_bytes_per_block(handle, _blockSize));
+        Check(archive_write_set_bytes_in_last_block(handle, 1));
+    }
+
+    /// <summary>
+    /// Create the named archive, replacing any existing file
+    /// </summary>
+    /// <param name="filename"></param>
+    /// <param name="format"></param>
+    /// <param name="filter">Compression applied over the whole archive; zip and 7z compress per entry instead</param>
+    /// <param name="compressionLevel">Level for the filter, or the zip/7z entry compression; -1 for the default</param>
+    /// <param name="threads">Compression threads, for the zstd and xz filters; 0 for the default (single threaded)</param>
+    /// <param name="options">Further libarchive options, e.g. "zip:encryption=aes256,zip:password=secret"</param>
+    /// <param name="blockSize">Output block size in bytes, default 1 MiB</param>
+    /// <exception cref="ArchiveException">The format, filter or an option is not supported</exception>
+    public LibArchiveWriter(string filename, ArchiveFormat format, ArchiveFilter filter = ArchiveFilter.None,
+        int compressionLevel = -1, int threads = 0, string? options = null, uint blockSize = 1<<20)
+        : this(format, filter, compressionLevel, threads, options, blockSize)
+    {
+        using var uName = new SafeStringBuffer(filename);
+        Check(archive_write_open_filename(handle, uName.Ptr));
+    }
+
+    /// <summary>
+    /// Write an archive to a Stream, which need not be seekable
+    /// </summary>
+    /// <param name="stream"></param>
+    /// <param name="format"></param>
+    /// <param name="filter">Compression applied over the whole archive; zip and 7z compress per entry instead</param>
+    /// <param name="compressionLevel">Level for the filter, or the zip/7z entry compression; -1 for the default</param>
+    /// <param name="threads">Compression threads, for the zstd and xz filters; 0 for the default (single threaded)</param>
+    /// <param name="options">Further libarchive options, e.g. "zip:encryption=aes256,zip:password=secret"</param>
+    /// <param name="blockSize">Output block size in bytes, default 1 MiB</param>
+    /// <param name="leaveOpen">Leave the stream open when the writer is finished or disposed</param>
+    /// <exception cref="ArchiveException">The format, filter or an option is not supported</exception>
+    public LibArchiveWriter(Stream stream, ArchiveFormat format, ArchiveFilter filter = ArchiveFilter.None,
+        int compressionLevel = -1, int threads = 0, string? options = null, uint blockSize = 1<<20, bool leaveOpen = false)
+        : this(format, filter, compressionLevel, threads, options, blockSize)
+    {
+        if (stream is null)
+            throw new ArgumentNullException(nameof(stream));
+        _sink = new StreamSink(stream, leaveOpen);
+        Check(_sink.Open(handle));
+    }
+
+    private static string FormatName(ArchiveFormat format) => format switch
+    {
+        ArchiveFormat.Tar => "paxr",
+        ArchiveFormat.Pax => "pax",
+        ArchiveFormat.Ustar => "ustar",
+        ArchiveFormat.GnuTar => "gnutar",
+        ArchiveFormat.Cpio => "newc",
+        ArchiveFormat.Zip => "zip",
+        ArchiveFormat.SevenZip => "7zip",
+        ArchiveFormat.Iso9660 => "iso9660",
+        ArchiveFormat.Xar => "xar",
+        _ => throw new ArgumentOutOfRangeException(nameof(format))
+    };
+
+    private int Set(Func<IntPtr, IntPtr, int> setter, string value)
+    {
+        using var uValue = new SafeStringBuffer(value);
+        return setter(handle, uValue.Ptr);
+    }
+
+    /// <summary>
+    /// Add a directory entry
+    /// </summary>
+    /// <param name="name">Path within the archive, '/' separated</param>
+    /// <param name="lastModified"></param>
+    /// <param name="permissions">Permission bits, default 0755</param>
+    public void AddDirectory(string name, DateTimeOffset? lastModified = null, int permissions = 0x1ED)
+    {
+        Header(name, AE_IFDIR, 0, lastModified, permissions);
+        Check(archive_write_finish_entry(handle));
+    }
+
+    /// <summary>
+    /// Add a file entry holding data
+    /// </summary>
+    /// <param name="name">Path within the archive, '/' separated</param>
+    /// <param name="data"></param>
+    /// <param name="lastModified"></param>
+    /// <param name="permissions">Permission bits, default 0644</param>
+    public void AddFile(string name, ReadOnlySpan<byte> data, DateTimeOffset? lastModified = null, int permissions = 0x1A4)
+    {
+        Header(name, AE_IFREG, data.Length, lastModified, permissions);
+        Write(data);
+        Check(archive_write_finish_entry(handle));
+    }
+
+    /// <summary>
+    /// Add a file entry holding the next length bytes of data. Most formats store the size ahead of
+    /// the data, so when length is not given and data cannot seek, data is first read into memory.
+    /// </summary>
+    /// <param name="name">Path within the archive, '/' separated</param>
+    /// <param name="data"></param>
+    /// <param name="length">Bytes to take from data; -1 for the rest of the stream</param>
+    /// <param name="lastModified"></param>
+    /// <param name="permissions">Permission bits, default 0644</param>
+    /// <exception cref="EndOfStreamException">data ended before length bytes</exception>
+    public void AddFile(string name, Stream data, long length = -1, DateTimeOffset? lastModified = null, int permissions = 0x1A4)
+    {
+        if (data is null)
+            throw new ArgumentNullException(nameof(data));
+        if (length < 0 && !data.CanSeek)
+        {
+            using var buffered = new MemoryStream();
+            data.CopyTo(buffered);
+            AddFile(name, buffered.GetBuffer().AsSpan(0, (int)buffered.Length), lastModified, permissions);
+            return;
+        }
+        if (length < 0)
+            length = Math.Max(data.Length - data.Position, 0);
+
+        Header(name, AE_IFREG, length, lastModified, permissions);
+        var buffer = ArrayPool<byte>.Shared.Rent((int)Math.Min(length, _blockSize));
+        try
+        {
+            while (length > 0)
+            {
+                var r = data.Read(buffer, 0, (int)Math.Min(length, buffer.Length));
+                if (r == 0)
+                    throw new EndOfStreamException($"Stream for '{name}' ended {length} bytes early");
+                Write(buffer.AsSpan(0, r));
+                length -= r;
+            }
+        }
+        finally
+        {
+            ArrayPool<byte>.Shared.Return(buffer);
+        }
+        Check(archive_write_finish_entry(handle));
+    }
+
+    /// <summary>
+    /// Complete the archive and flush it to the sink, reporting any error; disposing without
+    /// finishing also completes the archive, but discards errors
+    /// </summary>
+    /// <exception cref="ArchiveException"></exception>
+    public void Finish()
+    {
+        Check(archive_write_close(handle));
+    }
+
+    private unsafe void Header(string name, uint type, long size, DateTimeOffset? lastModified, int permissions)
+    {
+        if (name is null)
+            throw new ArgumentNullException(nameof(name));
+        archive_entry_clear(_entry);
+        var max = Encoding.UTF8.GetMaxByteCount(name.Length) + 1;
+        Span<byte> utf8 = max <= 1024 ? stackalloc byte[max] : new byte[max];
+        utf8[Encoding.UTF8.GetBytes(name, utf8)] = 0;
+        fixed (byte* p = utf8)
+            archive_entry_set_pathname_utf8(_entry, p);
+        archive_entry_set_filetype(_entry, type);
+        archive_entry_set_perm(_entry, (uint)permissions & 0xFFF);
+        archive_entry_set_size(_entry, size);
+        if (lastModified is { } mtime)
+            archive_entry_set_mtime(_entry, mtime.ToUnixTimeSeconds(), (nint)(mtime.UtcTicks % TimeSpan.TicksPerSecond * 100));
+        Check(archive_write_header(handle, _entry));
+    }
+
+    private unsafe void Write(ReadOnlySpan<byte> data)
+    {
+        fixed (byte* p = data)
+        {
+            var done = 0;
+            while (done < data.Length)
+            {
+                var r = archive_write_data(handle, p + done, (nuint)(data.Length - done));
+                if (r <= 0)
+                    Throw(r < 0 ? (int)r : (int)ArchiveResult.Fatal);
+                done += (int)r;
+            }
+        }
+    }
+
+    private void Check(int result)
+    {
+        if (result < ARCHIVE_WARN)
+            Throw(result);
+    }
+
+    private void Throw(int result)
+    {
+        _sink?.ThrowIfFailed();
+        throw ArchiveException.From(handle, result, "Archive write failed");
+    }
+
+    protected override bool ReleaseHandle()
+    {
+        archive_write_free(handle);
+        archive_entry_free(_entry);
+        _sink?.Dispose();
+        return true;
+    }
+}
@@ -0,0 +1,50 @@
+using System;
+using System.IO;
+using System.IO.MemoryMappedFiles;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// A read-only view of an entire file mapped into the address space, for feeding straight to
+/// archive_read_open_memory. Pages come from the OS page cache, so concurrent readers of the same
+/// file share them.
+/// </summary>
+internal sealed unsafe class MappedFile : IDisposable
+{
+    private readonly MemoryMappedFile? _file;
+    private readonly MemoryMappedViewAccessor? _view;
+
+    public IntPtr Ptr { get; }
+    public long Length { get; }
+
+    public MappedFile(string filename)
+    {
+        Length = new FileInfo(filename).Length;
+        // Zero-length files cannot be mapped; libarchive is happy with an empty buffer instead
+        if (Length == 0)
+            return;
+        _file = MemoryMappedFile.CreateFromFile(filename, FileMode.Open, null, 0, MemoryMappedFileAccess.Read);
+        try
+        {
+            _view = _file.CreateViewAccessor(0, Length, MemoryMappedFileAccess.Read);
+            byte* p = null;
+            _view.SafeMemoryMappedViewHandle.AcquirePointer(ref p);
+            Ptr = (IntPtr)(p + _view.PointerOffset);
+        }
+        catch
+        {
+            _view?.Dispose();
+            _file.Dispose();
+            throw;
+        }
+    }
+
+    public void Dispose()
+    {
+        if (_view is null)
+            return;
+        _view.SafeMemoryMappedViewHandle.ReleasePointer();
+        _view.Dispose();
+        _file?.Dispose();
+    }
+}
@@ -0,0 +1,359 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+using System.Runtime.Intrinsics.X86;
+
+[assembly: DefaultDllImportSearchPaths(DllImportSearchPath.AssemblyDirectory)]
+namespace LibArchive.Net;
+
+/// <summary>
+/// All libarchive entry points. Every signature is blittable (raw pointers, no ref/out, string or bool
+/// marshalling), so calls need no marshalling stub and the assembly is safe to trim and AOT-compile.
+/// Trivial accessors which neither block, allocate nor call back into managed code are marked
+/// SuppressGCTransition, avoiding the GC mode switch on every call; that matters when enumerating
+/// millions of small entries.
+/// </summary>
+internal static unsafe class Native
+{
+    private const string Lib = "archive";
+
+    private static nint _library;
+
+#pragma warning disable CA2255 // The resolver must be in place before any P/Invoke in this assembly runs
+    [ModuleInitializer]
+#pragma warning restore CA2255
+    internal static void Initialize()
+    {
+        // Unresolved, the runtime falls back to its own search, e.g. for a system libarchive
+        NativeLibrary.SetDllImportResolver(typeof(Native).Assembly,
+            (name, asm, path) => name == Lib ? Library : IntPtr.Zero);
+    }
+
+    /// <summary>
+    /// The bundled libarchive, or zero if there is none for this platform. Loaded on first use and
+    /// cached, so only the first P/Invoke pays for the search; racing loads return the same handle.
+    /// </summary>
+    internal static nint Library => _library != IntPtr.Zero ? _library : _library = Load();
+
+    /// <summary>
+    /// The file Library was loaded from, if any
+    /// </summary>
+    internal static string? LibraryPath { get; private set; }
+
+    /// <summary>
+    /// Try each file which may hold this platform's library under the application's base directory:
+    /// the NuGet runtimes/rid/native layout, the same file flattened beside the application by a
+    /// RID-specific or single-file publish, then the older runtimes/rid layout
+    /// </summary>
+    private static nint Load()
+    {
+        var arch = RuntimeInformation.ProcessArchitecture;
+        var candidates = new List<string>(6);
+        if (RuntimeInformation.IsOSPlatform(OSPlatform.Linux) && arch == Architecture.X64)
+        {
+            // The x86-64-v3 build is optional, so fall back to the baseline if it is missing
+            if (IsX64V3)
+                candidates.AddRange(new[]
+                {
+                    "runtimes/linux-x64/native/libarchive-x86-64-v3.so", "libarchive-x86-64-v3.so",
+                    "runtimes/linux-x64-v3/libarchive.so"
+                });
+            candidates.AddRange(new[]
+                { "runtimes/linux-x64/native/libarchive.so", "libarchive.so", "runtimes/linux-x64/libarchive.so" });
+        }
+        else if (RuntimeInformation.IsOSPlatform(OSPlatform.Linux) && arch == Architecture.Arm64)
+            candidates.AddRange(new[]
+                { "runtimes/linux-arm64/native/libarchive.so", "libarchive.so", "runtimes/linux-arm64/libarchive.so" });
+        else if (RuntimeInformation.IsOSPlatform(OSPlatform.OSX) && arch is Architecture.X64 or Architecture.Arm64)
+            candidates.AddRange(new[]
+                { "runtimes/osx/native/libarchive.dylib", "libarchive.dylib", "runtimes/osx-any64/libarchive.dylib" });
+        else if (RuntimeInformation.IsOSPlatform(OSPlatform.Windows) && arch == Architecture.X64)
+            candidates.AddRange(new[] { "runtimes/win-x64/native/archive.dll", "archive.dll", "runtimes/win-x64/archive.dll" });
+
+        // AppContext.BaseDirectory, unlike the AppDomain's, is also right for single-file applications
+        var baseDirectory = AppContext.BaseDirectory;
+        foreach (var candidate in candidates)
+        {
+            var file = Path.Combine(baseDirectory, candidate);
+            if (File.Exists(file) && NativeLibrary.TryLoad(file, out var handle))
+            {
+                LibraryPath = file;
+                return handle;
+            }
+        }
+        return IntPtr.Zero;
+    }
+
+    /// <summary>
+    /// Whether the CPU has the x86-64-v3 extensions the libarchive-x86-64-v3 library is compiled for;
+    /// .Net exposes no test for F16C or MOVBE, which every CPU with the others has too
+    /// </summary>
+    private static bool IsX64V3 => Avx2.IsSupported && Bmi1.IsSupported && Bmi2.IsSupported && Fma.IsSupported &&
+                                   Lzcnt.IsSupported;
+
+    // Library
+
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern int archive_version_number();
+
+    // Reader lifecycle
+
+    [DllImport(Lib)]
+    internal static extern IntPtr archive_read_new();
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_support_filter_all(IntPtr a);
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_support_format_all(IntPtr a);
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_support_filter_by_code(IntPtr a, int code);
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_support_format_by_code(IntPtr a, int code);
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_support_format_zip_streamable(IntPtr a);
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_set_options(IntPtr a, IntPtr options);
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_open_filename(IntPtr a, IntPtr filename, nuint blocksize);
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_open1(IntPtr a);
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_open_memory(IntPtr a, IntPtr buff, nuint size);
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_free(IntPtr a);
+
+    // Reader callbacks
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_set_read_callback(IntPtr a, IntPtr callback);
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_set_skip_callback(IntPtr a, IntPtr callback);
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_set_seek_callback(IntPtr a, IntPtr callback);
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_set_close_callback(IntPtr a, IntPtr callback);
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_set_callback_data(IntPtr a, IntPtr data);
+
+    // Headers and data: these may block, decompress or invoke callbacks, so keep the GC transition
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_next_header(IntPtr a, IntPtr* entry);
+
+    [DllImport(Lib)]
+    internal static extern nint archive_read_data(IntPtr a, byte* buff, nuint size);
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_data_block(IntPtr a, IntPtr* buff, nuint* size, long* offset);
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_data_skip(IntPtr a);
+
+    // Archive state
+
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern IntPtr archive_error_string(IntPtr a);
+
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern int archive_errno(IntPtr a);
+
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern int archive_format(IntPtr a);
+
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern int archive_filter_code(IntPtr a, int n);
+
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern IntPtr archive_format_name(IntPtr a);
+
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern int archive_filter_count(IntPtr a);
+
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern IntPtr archive_filter_name(IntPtr a, int n);
+
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern long archive_read_header_position(IntPtr a);
+
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern long archive_filter_bytes(IntPtr a, int n);
+
+    // Entry accessors. The path and link getters may convert between character sets, allocating and
+    // taking locale locks as they do, and archive_entry_sparse_count may free a sparse list it finds
+    // unusable, so unlike the plain field getters they keep the GC transition.
+
+    [DllImport(Lib)]
+    internal static extern IntPtr archive_entry_pathname(IntPtr entry);
+
+    [DllImport(Lib)]
+    internal static extern IntPtr archive_entry_pathname_utf8(IntPtr entry);
+
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern long archive_entry_size(IntPtr entry);
+
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern int archive_entry_size_is_set(IntPtr entry);
+
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern uint archive_entry_filetype(IntPtr entry);
+
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern uint archive_entry_perm(IntPtr entry);
+
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern long archive_entry_mtime(IntPtr entry);
+
+    // C long: 32 bits on Windows, but the value is always below 10^9
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern int archive_entry_mtime_nsec(IntPtr entry);
+
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern int archive_entry_mtime_is_set(IntPtr entry);
+
+    [DllImport(Lib)]
+    internal static extern IntPtr archive_entry_hardlink(IntPtr entry);
+
+    [DllImport(Lib)]
+    internal static extern IntPtr archive_entry_hardlink_utf8(IntPtr entry);
+
+    [DllImport(Lib)]
+    internal static extern IntPtr archive_entry_symlink(IntPtr entry);
+
+    [DllImport(Lib)]
+    internal static extern int archive_entry_sparse_count(IntPtr entry);
+
+    // Writer lifecycle
+
+    [DllImport(Lib)]
+    internal static extern IntPtr archive_write_new();
+
+    [DllImport(Lib)]
+    internal static extern int archive_write_set_format_by_name(IntPtr a, IntPtr name);
+
+    [DllImport(Lib)]
+    internal static extern int archive_write_add_filter_by_name(IntPtr a, IntPtr name);
+
+    [DllImport(Lib)]
+    internal static extern int archive_write_set_options(IntPtr a, IntPtr options);
+
+    [DllImport(Lib)]
+    internal static extern int archive_write_set_bytes_per_block(IntPtr a, int bytesPerBlock);
+
+    [DllImport(Lib)]
+    internal static extern int archive_write_set_bytes_in_last_block(IntPtr a, int bytesInLastBlock);
+
+    [DllImport(Lib)]
+    internal static extern int archive_write_open_filename(IntPtr a, IntPtr filename);
+
+    [DllImport(Lib)]
+    internal static extern int archive_write_open(IntPtr a, IntPtr data, IntPtr open, IntPtr write, IntPtr close);
+
+    [DllImport(Lib)]
+    internal static extern int archive_write_close(IntPtr a);
+
+    [DllImport(Lib)]
+    internal static extern int archive_write_free(IntPtr a);
+
+    // Writer headers and data: these compress and invoke the write callback
+
+    [DllImport(Lib)]
+    internal static extern int archive_write_header(IntPtr a, IntPtr entry);
+
+    [DllImport(Lib)]
+    internal static extern nint archive_write_data(IntPtr a, byte* buff, nuint size);
+
+    [DllImport(Lib)]
+    internal static extern int archive_write_finish_entry(IntPtr a);
+
+    // Disk writer
+
+    [DllImport(Lib)]
+    internal static extern IntPtr archive_write_disk_new();
+
+    [DllImport(Lib)]
+    internal static extern int archive_write_disk_set_options(IntPtr a, int flags);
+
+    [DllImport(Lib)]
+    internal static extern int archive_write_disk_set_standard_lookup(IntPtr a);
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_extract2(IntPtr a, IntPtr entry, IntPtr dest);
+
+    [DllImport(Lib)]
+    internal static extern int archive_read_data_into_fd(IntPtr a, int fd);
+
+    // Entry construction. Clearing frees and setting a path copies, so only the numeric setters
+    // skip the GC transition.
+
+    [DllImport(Lib)]
+    internal static extern IntPtr archive_entry_new();
+
+    [DllImport(Lib)]
+    internal static extern void archive_entry_free(IntPtr entry);
+
+    [DllImport(Lib)]
+    internal static extern IntPtr archive_entry_clear(IntPtr entry);
+
+    [DllImport(Lib)]
+    internal static extern void archive_entry_set_pathname_utf8(IntPtr entry, byte* name);
+
+    [DllImport(Lib)]
+    internal static extern void archive_entry_set_pathname(IntPtr entry, byte* name);
+
+    [DllImport(Lib)]
+    internal static extern void archive_entry_set_hardlink(IntPtr entry, byte* name);
+
+    // The update variants also set the path in the locale's encoding, returning 0 if it has no form there
+
+    [DllImport(Lib)]
+    internal static extern int archive_entry_update_pathname_utf8(IntPtr entry, byte* name);
+
+    [DllImport(Lib)]
+    internal static extern int archive_entry_update_hardlink_utf8(IntPtr entry, byte* name);
+
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern void archive_entry_set_size(IntPtr entry, long size);
+
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern void archive_entry_set_filetype(IntPtr entry, uint type);
+
+    // mode_t is narrower than 32 bits on some platforms; it is passed in a register either way
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern void archive_entry_set_perm(IntPtr entry, uint perm);
+
+    // C long nsec: register-sized argument, only the low 32 bits are read on Windows
+    [DllImport(Lib), SuppressGCTransition]
+    internal static extern void archive_entry_set_mtime(IntPtr entry, long sec, nint nsec);
+
+    // Matching
+
+    [DllImport(Lib)]
+    internal static extern IntPtr archive_match_new();
+
+    [DllImport(Lib)]
+    internal static extern int archive_match_free(IntPtr m);
+
+    [DllImport(Lib)]
+    internal static extern int archive_match_include_pattern(IntPtr m, IntPtr pattern);
+
+    [DllImport(Lib)]
+    internal static extern int archive_match_exclude_pattern(IntPtr m, IntPtr pattern);
+
+    [DllImport(Lib)]
+    internal static extern int archive_match_path_excluded(IntPtr m, IntPtr entry);
+}
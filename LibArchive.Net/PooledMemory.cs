@@ -0,0 +1,30 @@
+using System;
+using System.Buffers;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// The first length bytes of an ArrayPool array, returned to the pool on disposal
+/// </summary>
+internal sealed class PooledMemory : IMemoryOwner<byte>
+{
+    private byte[]? _array;
+    private readonly int _length;
+
+    public PooledMemory(byte[] array, int length)
+    {
+        _array = array;
+        _length = length;
+    }
+
+    public Memory<byte> Memory => (_array ?? throw new ObjectDisposedException(nameof(PooledMemory))).AsMemory(0, _length);
+
+    public void Dispose()
+    {
+        if (_array is { } array)
+        {
+            _array = null;
+            ArrayPool<byte>.Shared.Return(array);
+        }
+    }
+}
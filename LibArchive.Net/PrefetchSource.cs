@@ -0,0 +1,145 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Runtime.InteropServices;
+using System.Threading.Tasks;
+using Microsoft.Win32.SafeHandles;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// Feed libarchive from a file with several block reads in flight at once, through RandomAccess
+/// (overlapped I/O on Windows, pread on the thread pool elsewhere), so that on high-latency storage
+/// such as NFS, EFS or SMB the decompressor is rarely left waiting on a round trip. Reads are issued
+/// ahead of the position libarchive has reached; a skip landing within them keeps them, any other
+/// seek discards them.
+/// </summary>
+internal sealed class PrefetchSource : CallbackSource
+{
+    private readonly SafeFileHandle _file;
+    private readonly long _length;
+    // One pinned buffer more than the queue depth, for the block libarchive is working on
+    private readonly byte[][] _buffers;
+    private readonly Stack<int> _free = new();
+    private readonly Queue<(int Buffer, long Offset, Task<int> Read)> _reads = new();
+    private int _held = -1;
+    // Where the next read is to be issued from, and how far libarchive has got
+    private long _issued;
+    private long _position;
+
+    public PrefetchSource(string filename, int depth, int blockSize, bool sequentialScan)
+    {
+        if (depth < 1)
+            throw new ArgumentOutOfRangeException(nameof(depth), depth, "At least one read must be in flight");
+        _file = File.OpenHandle(filename, FileMode.Open, FileAccess.Read, FileShare.Read,
+            FileOptions.Asynchronous | (sequentialScan ? FileOptions.SequentialScan : FileOptions.None));
+        _length = RandomAccess.GetLength(_file);
+        _buffers = new byte[depth + 1][];
+        for (var i = _buffers.Length - 1; i >= 0; i--)
+        {
+            _buffers[i] = GC.AllocateUninitializedArray<byte>(blockSize, pinned: true);
+            _free.Push(i);
+        }
+    }
+
+    protected override int Read(out IntPtr buffer)
+    {
+        if (_held >= 0)
+            _free.Push(_held);
+        _held = -1;
+        Issue();
+        buffer = IntPtr.Zero;
+        if (_reads.Count == 0)
+            return 0;
+        var (held, offset, read) = _reads.Dequeue();
+        _held = held;
+        var length = read.GetAwaiter().GetResult();
+        // A short read anywhere but the end leaves a gap before the reads after it
+        if (length < Math.Min(_buffers[held].Length, _length - offset))
+            Discard(offset + length);
+        // A skip may have landed part-way into this block
+        var start = (int)(_position - offset);
+        _position = offset + length;
+        Issue();
+        buffer = Marshal.UnsafeAddrOfPinnedArrayElement(_buffers[held], start);
+        return Math.Max(length - start, 0);
+    }
+
+    /// <summary>
+    /// Put every free buffer to work reading the blocks after those already in flight
+    /// </summary>
+    private void Issue()
+    {
+        while (_free.Count > 0 && _issued < _length)
+        {
+            var i = _free.Pop();
+            _reads.Enqueue((i, _issued, RandomAccess.ReadAsync(_file, _buffers[i], _issued).AsTask()));
+            _issued += _buffers[i].Length;
+        }
+    }
+
+    protected override long Skip(long request)
+    {
+        var from = _position;
+        var to = Math.Min(from + request, _length);
+        // Reads wholly before the target are of no use, but those after it still are
+        while (_reads.TryPeek(out var next) && next.Offset + _buffers[next.Buffer].Length <= to)
+        {
+            _reads.Dequeue();
+            Wait(next.Read);
+            _free.Push(next.Buffer);
+        }
+        if (_reads.Count == 0)
+            _issued = to;
+        _position = to;
+        return to - from;
+    }
+
+    protected override bool CanSeek => true;
+
+    protected override long Seek(long offset, SeekOrigin origin)
+    {
+        var target = origin switch
+        {
+            SeekOrigin.Begin => offset,
+            SeekOrigin.Current => _position + offset,
+            _ => _length + offset
+        };
+        if (target < 0)
+            throw new IOException("Seek before the start of the file");
+        Discard(target);
+        return _position = target;
+    }
+
+    /// <summary>
+    /// Drop every read in flight, the next to be issued from offset
+    /// </summary>
+    private void Discard(long offset)
+    {
+        while (_reads.TryDequeue(out var read))
+        {
+            // Its buffer may only be reused once the read into it is done
+            Wait(read.Read);
+            _free.Push(read.Buffer);
+        }
+        _issued = offset;
+    }
+
+    private static void Wait(Task read)
+    {
+        try
+        {
+            read.Wait();
+        }
+        catch (AggregateException)
+        {
+            // The data is not wanted, so neither is its failure
+        }
+    }
+
+    protected override void Close()
+    {
+        Discard(_length);
+        _file.Dispose();
+    }
+}
@@ -0,0 +1,29 @@
+using System;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// Compression filters a LibArchiveReader will recognise; uncompressed input is always accepted
+/// </summary>
+[Flags]
+public enum ReadFilters
+{
+    None = 0,
+    Gzip = 1 << 0,
+    Bzip2 = 1 << 1,
+    Xz = 1 << 2,
+    Lzma = 1 << 3,
+    Lzip = 1 << 4,
+    Zstd = 1 << 5,
+    Lz4 = 1 << 6,
+    Compress = 1 << 7,
+    Uu = 1 << 8,
+    Rpm = 1 << 9,
+
+    // Depending on how libarchive was built, these may need the external program on the PATH
+    Lzop = 1 << 10,
+    Lrzip = 1 << 11,
+    Grzip = 1 << 12,
+
+    All = (1 << 13) - 1
+}
@@ -0,0 +1,42 @@
+using System;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// Archive formats a LibArchiveReader will recognise. Each one registered adds to the cost of
+/// creating a reader and of detecting the format on open.
+/// </summary>
+[Flags]
+public enum ReadFormats
+{
+    None = 0,
+    Tar = 1 << 0,
+    Cpio = 1 << 1,
+    Zip = 1 << 2,
+    SevenZip = 1 << 3,
+    Rar = 1 << 4,
+    Rar5 = 1 << 5,
+    Iso9660 = 1 << 6,
+    Cab = 1 << 7,
+    Lha = 1 << 8,
+    Xar = 1 << 9,
+    Ar = 1 << 10,
+    Mtree = 1 << 11,
+    Warc = 1 << 12,
+
+    /// <summary>
+    /// Zero-length input, read as an archive with no entries
+    /// </summary>
+    Empty = 1 << 13,
+
+    /// <summary>
+    /// Everything except Raw
+    /// </summary>
+    All = (1 << 14) - 1,
+
+    /// <summary>
+    /// Any input at all, read as a single entry named "data"; only useful alongside a filter, to
+    /// decompress a bare .gz, .xz or .zst stream
+    /// </summary>
+    Raw = 1 << 14
+}
@@ -0,0 +1,141 @@
+using System;
+using System.Collections.Generic;
+using System.Text;
+using static LibArchive.Net.Native;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// Which formats and filters a LibArchiveReader registers, and the options passed to them. Create
+/// one instance and share it between readers: the native option string is built once.
+/// </summary>
+public sealed class ReaderOptions
+{
+    private const int ARCHIVE_OK = 0;
+    private const int ARCHIVE_WARN = -20;
+
+    private static readonly (ReadFormats Flag, int Code)[] FormatCodes =
+    {
+        (ReadFormats.Tar, 0x30000),
+        (ReadFormats.Cpio, 0x10000),
+        (ReadFormats.Zip, 0x50000),
+        (ReadFormats.SevenZip, 0xE0000),
+        (ReadFormats.Rar, 0xD0000),
+        (ReadFormats.Rar5, 0x100000),
+        (ReadFormats.Iso9660, 0x40000),
+        (ReadFormats.Cab, 0xC0000),
+        (ReadFormats.Lha, 0xB0000),
+        (ReadFormats.Xar, 0xA0000),
+        (ReadFormats.Ar, 0x70000),
+        (ReadFormats.Mtree, 0x80000),
+        (ReadFormats.Warc, 0xF0000),
+        (ReadFormats.Empty, 0x60000),
+        (ReadFormats.Raw, 0x90000)
+    };
+
+    private static readonly (ReadFilters Flag, int Code)[] FilterCodes =
+    {
+        (ReadFilters.Gzip, 1),
+        (ReadFilters.Bzip2, 2),
+        (ReadFilters.Compress, 3),
+        (ReadFilters.Lzma, 5),
+        (ReadFilters.Xz, 6),
+        (ReadFilters.Uu, 7),
+        (ReadFilters.Rpm, 8),
+        (ReadFilters.Lzip, 9),
+        (ReadFilters.Lrzip, 10),
+        (ReadFilters.Lzop, 11),
+        (ReadFilters.Grzip, 12),
+        (ReadFilters.Lz4, 13),
+        (ReadFilters.Zstd, 14)
+    };
+
+    private byte[]? _options;
+
+    /// <summary>
+    /// The defaults: every format except Raw, every filter, no options
+    /// </summary>
+    public static ReaderOptions Default { get; } = new();
+
+    public ReadFormats Formats { get; init; } = ReadFormats.All;
+
+    public ReadFilters Filters { get; init; } = ReadFilters.All;
+
+    /// <summary>
+    /// Character set of entry names in formats which do not record one (tar, cpio, zip, rar, lha,
+    /// cab, iso9660), e.g. "CP437" or "Shift_JIS". At least one of Formats must accept it.
+    /// </summary>
+    public string? HeaderCharset { get; init; }
+
+    /// <summary>
+    /// Carry on past a tar end-of-archive marker, reading concatenated tar archives as one
+    /// </summary>
+    public bool ReadConcatenatedArchives { get; init; }
+
+    /// <summary>
+    /// Skip zip CRC-32 verification; Formats must include Zip
+    /// </summary>
+    public bool IgnoreZipCrc32 { get; init; }
+
+    /// <summary>
+    /// Further libarchive read options as "module:option=value,...", e.g. "iso9660:!rockridge"
+    /// </summary>
+    public string? Options { get; init; }
+
+    /// <summary>
+    /// Which libarchive warnings and failures readers carry on past rather than throw on, default Strict
+    /// </summary>
+    public ErrorPolicy ErrorPolicy { get; init; }
+
+    /// <summary>
+    /// Register the formats and filters with a new reader handle and set its options
+    /// </summary>
+    /// <returns>The first failing libarchive result, or ARCHIVE_OK</returns>
+    internal unsafe int Apply(IntPtr archive)
+    {
+        var allFormats = (Formats & ReadFormats.All) == ReadFormats.All;
+        if (allFormats)
+            archive_read_support_format_all(archive);
+        foreach (var (flag, code) in FormatCodes)
+        {
+            if ((Formats & flag) == 0 || allFormats && flag != ReadFormats.Raw)
+                continue;
+            var r = archive_read_support_format_by_code(archive, code);
+            if (r < ARCHIVE_WARN)
+                return r;
+        }
+
+        // Filters needing an external program only warn when it is missing; they fail on open instead
+        if (Filters == ReadFilters.All)
+            archive_read_support_filter_all(archive);
+        else
+            foreach (var (flag, code) in FilterCodes)
+            {
+                if ((Filters & flag) == 0)
+                    continue;
+                var r = archive_read_support_filter_by_code(archive, code);
+                if (r < ARCHIVE_WARN)
+                    return r;
+            }
+
+        _options ??= NativeOptions();
+        if (_options.Length == 1)
+            return ARCHIVE_OK;
+        fixed (byte* p = _options)
+            return archive_read_set_options(archive, (IntPtr)p);
+    }
+
+    private byte[] NativeOptions()
+    {
+        var options = new List<string>();
+        if (!string.IsNullOrEmpty(HeaderCharset))
+            options.Add($"hdrcharset={HeaderCharset}");
+        if (ReadConcatenatedArchives)
+            options.Add("tar:read_concatenated_archives");
+        if (IgnoreZipCrc32)
+            options.Add("zip:ignorecrc32");
+        if (!string.IsNullOrEmpty(Options))
+            options.Add(Options);
+        return Encoding.UTF8.GetBytes(string.Join(",", options) + "\0");
+    }
+}
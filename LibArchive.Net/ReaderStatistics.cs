@@ -0,0 +1,26 @@
+using System;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// What a LibArchiveReader has done so far, from LibArchiveReader.Statistics. Also published when
+/// the reader is disposed, through the "LibArchive.Net" Meter and EventSource.
+/// </summary>
+/// <param name="Format">libarchive's name for the detected format, e.g. "ZIP 2.0 (deflation)"; empty before the first header</param>
+/// <param name="Filters">Filters applied to the input, innermost (nearest the archive data) first, e.g. "gzip", or
+/// "xz+gzip" for a gzipped .tar.xz; "none" if uncompressed</param>
+/// <param name="CompressedBytes">Bytes consumed from the file, memory or Stream</param>
+/// <param name="UncompressedBytes">Bytes of entry data returned, including data written by ExtractTo</param>
+/// <param name="Headers">Entry headers read</param>
+/// <param name="HeaderTime">Time inside archive_read_next_header and archive_read_data_skip</param>
+/// <param name="DataTime">Time inside archive_read_data, archive_read_data_block and extraction</param>
+/// <param name="Warnings">Warnings, retries and failed entries let pass by ReaderOptions.ErrorPolicy</param>
+public sealed record ReaderStatistics(
+    string Format,
+    string Filters,
+    long CompressedBytes,
+    long UncompressedBytes,
+    int Headers,
+    TimeSpan HeaderTime,
+    TimeSpan DataTime,
+    int Warnings);
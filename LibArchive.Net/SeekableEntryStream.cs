@@ -0,0 +1,198 @@
+using System;
+using System.IO;
+using Microsoft.Win32.SafeHandles;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// Random access to one entry's data, opened by Entry.OpenSeekable. Data stored as is in the archive
+/// is read at its offset in the file or memory. Compressed data is decoded forwards through a ring
+/// holding the most recent window of it: libarchive cannot save or restore decoder state, so a seek
+/// back past the window reopens the entry and decodes up to the new position again.
+/// </summary>
+internal sealed class SeekableEntryStream : Stream
+{
+    // Stored data
+    private readonly SafeFileHandle? _file;
+    private readonly ReadOnlyMemory<byte> _stored;
+    private readonly long _dataOffset = -1;
+
+    // Decoded data
+    private readonly LibArchiveReader? _origin;
+    private readonly string _name = "";
+    private readonly int _ordinal;
+    private readonly long _headerOffset;
+    private readonly int _format;
+    private readonly byte[]? _window;
+    private LibArchiveReader? _reader;
+    private bool _borrowed;
+    private int _serial;
+    private long _decoded;
+    private int _filled;
+
+    private long _position;
+
+    /// <summary>
+    /// Data stored at offset in file, which the stream takes ownership of
+    /// </summary>
+    public SeekableEntryStream(SafeFileHandle file, long offset, long length)
+    {
+        _file = file;
+        _dataOffset = offset;
+        Length = length;
+    }
+
+    /// <summary>
+    /// Data stored in memory
+    /// </summary>
+    public SeekableEntryStream(ReadOnlyMemory<byte> stored)
+    {
+        _stored = stored;
+        _dataOffset = 0;
+        Length = stored.Length;
+    }
+
+    /// <summary>
+    /// Data decoded from origin's entry number ordinal, whose header is at headerOffset in the file if
+    /// known. Until origin moves on, decoding continues from its current entry unless started is set.
+    /// </summary>
+    public SeekableEntryStream(LibArchiveReader origin, string name, int ordinal, long headerOffset, int format,
+        long length, bool started, int windowSize)
+    {
+        _origin = origin;
+        _name = name;
+        _ordinal = ordinal;
+        _headerOffset = headerOffset;
+        _format = format;
+        _window = GC.AllocateUninitializedArray<byte>((int)Math.Min(windowSize, Math.Max(length, 1)));
+        Length = length;
+        if (started)
+            return;
+        // Hold the handle open for as long as we may read from it
+        origin.DangerousAddRef(ref _borrowed);
+        _reader = origin;
+        _serial = origin.Serial;
+    }
+
+    public override int Read(byte[] buffer, int offset, int count)
+    {
+        return Read(buffer.AsSpan(offset, count));
+    }
+
+    public override int Read(Span<byte> buffer)
+    {
+        if (_position >= Length || buffer.IsEmpty)
+            return 0;
+        if (buffer.Length > Length - _position)
+            buffer = buffer[..(int)(Length - _position)];
+        int r;
+        if (_file is not null)
+            r = RandomAccess.Read(_file, buffer, _dataOffset + _position);
+        else if (_window is null)
+        {
+            _stored.Span.Slice((int)_position, buffer.Length).CopyTo(buffer);
+            r = buffer.Length;
+        }
+        else
+            r = ReadDecoded(buffer);
+        _position += r;
+        return r;
+    }
+
+    private int ReadDecoded(Span<byte> buffer)
+    {
+        var window = _window!;
+        // Before the window, or past it with no reader left to decode from
+        if (_position < _decoded - _filled ||
+            _position >= _decoded && (_reader is null || _borrowed && (_origin!.IsDisposed || _origin.Serial != _serial)))
+            Restart();
+        while (_decoded <= _position)
+        {
+            var r = _reader!.ReadData(window.AsSpan((int)(_decoded % window.Length)));
+            if (r == 0)
+                return 0;
+            _decoded += r;
+            _filled = (int)Math.Min(_filled + r, window.Length);
+        }
+
+        var available = (int)Math.Min(buffer.Length, _decoded - _position);
+        var at = (int)(_position % window.Length);
+        var first = Math.Min(available, window.Length - at);
+        window.AsSpan(at, first).CopyTo(buffer);
+        window.AsSpan(0, available - first).CopyTo(buffer[first..]);
+        return available;
+    }
+
+    /// <summary>
+    /// Decode again from the start of the entry, on a reader of our own
+    /// </summary>
+    private void Restart()
+    {
+        ReleaseReader();
+        (_reader, _) = _origin!.Reopen(_name, _ordinal, _headerOffset, _format);
+        _decoded = 0;
+        _filled = 0;
+    }
+
+    private void ReleaseReader()
+    {
+        if (_borrowed)
+        {
+            _borrowed = false;
+            _origin!.DangerousRelease();
+        }
+        else
+            _reader?.Dispose();
+        _reader = null;
+    }
+
+    public override long Seek(long offset, SeekOrigin origin)
+    {
+        var position = origin switch
+        {
+            SeekOrigin.Begin => offset,
+            SeekOrigin.Current => _position + offset,
+            SeekOrigin.End => Length + offset,
+            _ => throw new ArgumentOutOfRangeException(nameof(origin))
+        };
+        if (position < 0)
+            throw new IOException("An attempt was made to move the position before the beginning of the stream");
+        return _position = position;
+    }
+
+    public override long Position
+    {
+        get => _position;
+        set => Seek(value, SeekOrigin.Begin);
+    }
+
+    public override long Length { get; }
+
+    public override bool CanRead => true;
+    public override bool CanSeek => true;
+    public override bool CanWrite => false;
+
+    public override void Flush()
+    {
+    }
+
+    public override void SetLength(long value)
+    {
+        throw new NotSupportedException();
+    }
+
+    public override void Write(byte[] buffer, int offset, int count)
+    {
+        throw new NotSupportedException();
+    }
+
+    protected override void Dispose(bool disposing)
+    {
+        if (disposing)
+        {
+            _file?.Dispose();
+            ReleaseReader();
+        }
+        base.Dispose(disposing);
+    }
+}
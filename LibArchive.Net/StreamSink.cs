@@ -0,0 +1,92 @@
+using System;
+using System.IO;
+using System.Runtime.CompilerServices;
+using System.Runtime.ExceptionServices;
+using System.Runtime.InteropServices;
+using static LibArchive.Net.Native;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// Receive libarchive's output through its write/close callbacks and pass it on to a Stream.
+/// Blocks are written straight from libarchive's own buffer, without copying. As with
+/// CallbackSource, exceptions are captured here and rethrown by the writer.
+/// </summary>
+internal sealed class StreamSink : IDisposable
+{
+    private const int ARCHIVE_OK = 0;
+    private const int ARCHIVE_FATAL = -30;
+
+    private readonly Stream _stream;
+    private readonly bool _leaveOpen;
+    private GCHandle _self;
+    private ExceptionDispatchInfo? _error;
+
+    public StreamSink(Stream stream, bool leaveOpen)
+    {
+        if (!stream.CanWrite)
+            throw new ArgumentException("Stream must be writable", nameof(stream));
+        _stream = stream;
+        _leaveOpen = leaveOpen;
+    }
+
+    internal unsafe int Open(IntPtr archive)
+    {
+        _self = GCHandle.Alloc(this);
+        return archive_write_open(archive, GCHandle.ToIntPtr(_self), IntPtr.Zero,
+            (IntPtr)(delegate* unmanaged[Cdecl]<IntPtr, IntPtr, byte*, nuint, nint>)&WriteCallback,
+            (IntPtr)(delegate* unmanaged[Cdecl]<IntPtr, IntPtr, int>)&CloseCallback);
+    }
+
+    /// <summary>
+    /// Rethrow, once, any exception captured inside a callback
+    /// </summary>
+    internal void ThrowIfFailed()
+    {
+        var error = _error;
+        _error = null;
+        error?.Throw();
+    }
+
+    public void Dispose()
+    {
+        if (_self.IsAllocated)
+            _self.Free();
+    }
+
+    private static StreamSink From(IntPtr client) => (StreamSink)GCHandle.FromIntPtr(client).Target!;
+
+    [UnmanagedCallersOnly(CallConvs = new[] { typeof(CallConvCdecl) })]
+    private static unsafe nint WriteCallback(IntPtr archive, IntPtr client, byte* buffer, nuint length)
+    {
+        var sink = From(client);
+        try
+        {
+            sink._stream.Write(new ReadOnlySpan<byte>(buffer, (int)length));
+            return (nint)length;
+        }
+        catch (Exception e)
+        {
+            sink._error = ExceptionDispatchInfo.Capture(e);
+            return ARCHIVE_FATAL;
+        }
+    }
+
+    [UnmanagedCallersOnly(CallConvs = new[] { typeof(CallConvCdecl) })]
+    private static int CloseCallback(IntPtr archive, IntPtr client)
+    {
+        var sink = From(client);
+        try
+        {
+            sink._stream.Flush();
+            if (!sink._leaveOpen)
+                sink._stream.Dispose();
+            return ARCHIVE_OK;
+        }
+        catch (Exception e)
+        {
+            sink._error = ExceptionDispatchInfo.Capture(e);
+            return ARCHIVE_FATAL;
+        }
+    }
+}
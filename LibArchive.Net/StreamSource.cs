@@ -0,0 +1,68 @@
+using System;
+using System.IO;
+using System.Runtime.InteropServices;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// Feed libarchive from an arbitrary Stream through a pinned buffer. Offsets seen by libarchive are
+/// relative to the stream's position when the source was created.
+/// </summary>
+internal sealed class StreamSource : CallbackSource
+{
+    private readonly Stream _stream;
+    private readonly bool _leaveOpen;
+    private readonly byte[] _buffer;
+    private readonly long _origin;
+
+    public StreamSource(Stream stream, int blockSize, bool leaveOpen)
+        : this(stream, GC.AllocateUninitializedArray<byte>(blockSize, pinned: true), leaveOpen)
+    {
+    }
+
+    /// <summary>
+    /// Read through buffer, which must be pinned and not otherwise used until the source is disposed
+    /// </summary>
+    public StreamSource(Stream stream, byte[] buffer, bool leaveOpen)
+    {
+        if (!stream.CanRead)
+            throw new ArgumentException("Stream must be readable", nameof(stream));
+        _stream = stream;
+        _leaveOpen = leaveOpen;
+        _buffer = buffer;
+        _origin = stream.CanSeek ? stream.Position : 0;
+    }
+
+    internal byte[] Buffer => _buffer;
+
+    protected override int Read(out IntPtr buffer)
+    {
+        buffer = Marshal.UnsafeAddrOfPinnedArrayElement(_buffer, 0);
+        return _stream.Read(_buffer, 0, _buffer.Length);
+    }
+
+    protected override long Skip(long request)
+    {
+        if (!_stream.CanSeek)
+            return 0;
+        var from = _stream.Position;
+        var to = Math.Min(from + request, _stream.Length);
+        _stream.Position = to;
+        return to - from;
+    }
+
+    protected override bool CanSeek => _stream.CanSeek;
+
+    protected override long Seek(long offset, SeekOrigin origin)
+    {
+        if (origin == SeekOrigin.Begin)
+            offset += _origin;
+        return _stream.Seek(offset, origin) - _origin;
+    }
+
+    protected override void Close()
+    {
+        if (!_leaveOpen)
+            _stream.Dispose();
+    }
+}
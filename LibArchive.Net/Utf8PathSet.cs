@@ -0,0 +1,58 @@
+using System;
+using System.Collections.Generic;
+using System.Numerics;
+using System.Text;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// A fixed set of paths held as UTF-8, looked up directly with libarchive's raw pathname bytes so
+/// testing a header needs no string. Each path has an ordinal in [0, Count).
+/// </summary>
+internal sealed class Utf8PathSet
+{
+    private readonly byte[][] _paths;
+    private readonly int[] _hashes;
+    private readonly int[] _next;
+    // Ordinal + 1 of the first path in each bucket, zero if empty
+    private readonly int[] _buckets;
+
+    public Utf8PathSet(IEnumerable<string> paths)
+    {
+        var distinct = new HashSet<string>(paths, StringComparer.Ordinal);
+        _paths = new byte[distinct.Count][];
+        _hashes = new int[distinct.Count];
+        _next = new int[distinct.Count];
+        _buckets = new int[BitOperations.RoundUpToPowerOf2((uint)Math.Max(2, distinct.Count * 2))];
+        var i = 0;
+        foreach (var path in distinct)
+        {
+            _paths[i] = Encoding.UTF8.GetBytes(path);
+            _hashes[i] = Hash(_paths[i]);
+            ref var bucket = ref _buckets[_hashes[i] & (_buckets.Length - 1)];
+            _next[i] = bucket - 1;
+            bucket = ++i;
+        }
+    }
+
+    public int Count => _paths.Length;
+
+    /// <summary>
+    /// The ordinal of path, or -1 if it is not in the set
+    /// </summary>
+    public int IndexOf(ReadOnlySpan<byte> path)
+    {
+        var hash = Hash(path);
+        for (var i = _buckets[hash & (_buckets.Length - 1)] - 1; i >= 0; i = _next[i])
+            if (_hashes[i] == hash && path.SequenceEqual(_paths[i]))
+                return i;
+        return -1;
+    }
+
+    private static int Hash(ReadOnlySpan<byte> path)
+    {
+        var hash = new HashCode();
+        hash.AddBytes(path);
+        return hash.ToHashCode();
+    }
+}
@@ -0,0 +1,153 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Runtime.InteropServices;
+using System.Threading.Tasks;
+
+namespace LibArchive.Net;
+
+/// <summary>
+/// Feed libarchive the volumes of a split or multi-volume archive (.7z.001, .002, ... or
+/// .part1.rar, .part2.rar, ...) as one continuous stream, as archive_read_open_filenames does.
+/// While libarchive works on one block the next is read in the background, crossing into the
+/// next volume as needed, so opening and reading a volume overlaps with decompressing the last.
+/// If every volume is seekable, offsets seen by libarchive span the whole set, each volume
+/// starting at its position when the source was created.
+/// </summary>
+internal sealed class VolumeSource : CallbackSource
+{
+    private readonly Stream[] _volumes;
+    private readonly bool _leaveOpen;
+    // Two pinned buffers: libarchive holds one while the other is filled
+    private readonly byte[][] _buffers;
+    // If seekable, each volume's own starting position and its offset in the set: _starts[^1] is the total
+    private readonly long[]? _origins;
+    private readonly long[]? _starts;
+    // Volume being read, which buffer is filled next and the read-ahead filling it
+    private int _volume;
+    private int _next;
+    private Task<int>? _pending;
+    // Offset in the set of the end of the data given to libarchive
+    private long _position;
+
+    public VolumeSource(IReadOnlyList<Stream> volumes, int blockSize, bool leaveOpen)
+    {
+        if (volumes.Count == 0)
+            throw new ArgumentException("At least one volume is needed", nameof(volumes));
+        _volumes = new Stream[volumes.Count];
+        var seekable = true;
+        for (var i = 0; i < _volumes.Length; i++)
+        {
+            _volumes[i] = volumes[i] ?? throw new ArgumentNullException(nameof(volumes));
+            if (!_volumes[i].CanRead)
+                throw new ArgumentException("Streams must be readable", nameof(volumes));
+            seekable &= _volumes[i].CanSeek;
+        }
+        _leaveOpen = leaveOpen;
+        _buffers = new[]
+        {
+            GC.AllocateUninitializedArray<byte>(blockSize, pinned: true),
+            GC.AllocateUninitializedArray<byte>(blockSize, pinned: true)
+        };
+        if (!seekable)
+            return;
+        _origins = new long[_volumes.Length];
+        _starts = new long[_volumes.Length + 1];
+        for (var i = 0; i < _volumes.Length; i++)
+        {
+            _origins[i] = _volumes[i].Position;
+            _starts[i + 1] = _starts[i] + _volumes[i].Length - _origins[i];
+        }
+    }
+
+    protected override int Read(out IntPtr buffer)
+    {
+        var ready = _next;
+        var read = _pending is null ? Fill(ready) : _pending.GetAwaiter().GetResult();
+        _pending = null;
+        _next ^= 1;
+        _position += read;
+        buffer = Marshal.UnsafeAddrOfPinnedArrayElement(_buffers[ready], 0);
+        if (read > 0)
+        {
+            var next = _next;
+            _pending = Task.Run(() => Fill(next));
+        }
+        return read;
+    }
+
+    /// <summary>
+    /// Read the next block of the set into buffer i, moving on through the volumes until some data
+    /// is found or none is left
+    /// </summary>
+    private int Fill(int i)
+    {
+        for (; _volume < _volumes.Length; _volume++)
+        {
+            var read = _volumes[_volume].Read(_buffers[i], 0, _buffers[i].Length);
+            if (read > 0)
+                return read;
+            // After a seek back, a later volume may no longer be at its start
+            if (_origins is not null && _volume + 1 < _volumes.Length)
+                _volumes[_volume + 1].Position = _origins[_volume + 1];
+        }
+        return 0;
+    }
+
+    protected override long Skip(long request)
+    {
+        if (_starts is null)
+            return 0;
+        var from = _position;
+        return Seek(Math.Min(from + request, _starts[^1]), SeekOrigin.Begin) - from;
+    }
+
+    protected override bool CanSeek => _starts is not null;
+
+    protected override long Seek(long offset, SeekOrigin origin)
+    {
+        var target = origin switch
+        {
+            SeekOrigin.Begin => offset,
+            SeekOrigin.Current => _position + offset,
+            _ => _starts![^1] + offset
+        };
+        if (target < 0)
+            throw new IOException("Seek before the start of the first volume");
+        Discard();
+        // The last volume starting at or before target, ignoring empty ones
+        var volume = Array.BinarySearch(_starts!, 0, _volumes.Length, Math.Min(target, _starts![^1]));
+        if (volume < 0)
+            volume = ~volume - 1;
+        while (volume + 1 < _volumes.Length && _starts[volume + 1] <= target)
+            volume++;
+        _volume = volume;
+        _volumes[volume].Position = _origins![volume] + target - _starts[volume];
+        return _position = target;
+    }
+
+    /// <summary>
+    /// Wait out and drop any read-ahead, whose data no longer follows on
+    /// </summary>
+    private void Discard()
+    {
+        try
+        {
+            _pending?.Wait();
+        }
+        catch (AggregateException)
+        {
+            // The data is not wanted, so neither is its failure
+        }
+        _pending = null;
+    }
+
+    protected override void Close()
+    {
+        Discard();
+        if (_leaveOpen)
+            return;
+        foreach (var volume in _volumes)
+            volume.Dispose();
+    }
+}
@@ -29,4 +29,284 @@ public class SevenZipTests
         }
         Assert.Pass();
     }
-}
\ No newline at end of file
+
+    [Test]
+    public void SpanReadMatchesCopyTo()
+    {
+        using var lar = new LibArchiveReader("7ztest.7z");
+        foreach (var e in lar.Entries())
+        {
+            using var s = e.Stream;
+            if (e.Name != "1krandom")
+            {
+                s.CopyTo(Stream.Null);
+                continue;
+            }
+            var head = new byte[100];
+            Assert.AreEqual(100, s.Read(head.AsSpan()));
+            using var rest = new MemoryStream();
+            s.CopyTo(rest);
+            Assert.AreEqual(924, rest.Length);
+            var all = head.Concat(rest.ToArray()).ToArray();
+            Assert.AreEqual("da26f3be7a9a2df10a4935878b18c8fffe2b9613eacde2c867df8aa25d410d0a",
+                Convert.ToHexString(SHA256.HashData(all)).ToLowerInvariant());
+        }
+    }
+
+    [Test]
+    public void StreamEndsWhenTheReaderMovesOn()
+    {
+        using var lar = new LibArchiveReader("7ztest.7z");
+        Stream? previous = null;
+        var entries = 0;
+        foreach (var e in lar.Entries())
+        {
+            if (previous is not null)
+            {
+                Assert.AreEqual(0, previous.Read(new byte[100]));
+                using var copy = new MemoryStream();
+                previous.CopyTo(copy);
+                Assert.AreEqual(0, copy.Length);
+            }
+            // Nothing of this entry went to the stale stream
+            Assert.AreEqual(e.Size, e.ReadAllBytes().Length);
+            previous = e.Stream;
+            entries++;
+        }
+        Assert.Greater(entries, 1);
+    }
+
+    [Test]
+    public void OpenFromStream()
+    {
+        using var lar = new LibArchiveReader(File.OpenRead("7ztest.7z"));
+        Assert.AreEqual(Hashes("7ztest.7z"), Hashes(lar));
+    }
+
+    [Test]
+    public void OpenFromMemory()
+    {
+        using var lar = new LibArchiveReader(File.ReadAllBytes("7ztest.7z").AsMemory());
+        Assert.AreEqual(Hashes("7ztest.7z"), Hashes(lar));
+    }
+
+    [Test]
+    public void OpenMapped()
+    {
+        using var lar = LibArchiveReader.OpenMapped("7ztest.7z");
+        Assert.AreEqual(Hashes("7ztest.7z"), Hashes(lar));
+    }
+
+    [Test]
+    public void OpenPrefetched()
+    {
+        using (var lar = LibArchiveReader.OpenPrefetched("7ztest.7z"))
+            Assert.AreEqual(Hashes("7ztest.7z"), Hashes(lar));
+        using (var lar = LibArchiveReader.OpenPrefetched("7ztest.7z", 1, 4096, false))
+            Assert.AreEqual(Hashes("7ztest.7z"), Hashes(lar));
+    }
+
+    [Test]
+    public async Task EntriesAsyncMatchesSync()
+    {
+        using var lar = new LibArchiveReader("7ztest.7z");
+        using var hash = SHA256.Create();
+        StringBuilder sb = new();
+        var buffer = new byte[3 << 20];
+        await foreach (var e in lar.EntriesAsync())
+        {
+            await using var s = e.Stream;
+            int r;
+            while ((r = await s.ReadAsync(buffer)) > 0)
+                hash.TransformBlock(buffer, 0, r, null, 0);
+            hash.TransformFinalBlock(buffer, 0, 0);
+            sb.Append(e.Name).Append(' ').AppendLine(Convert.ToHexString(hash.Hash!));
+        }
+        Assert.AreEqual(Hashes("7ztest.7z"), sb.ToString());
+    }
+
+    [Test]
+    public void EntriesAsyncHonoursCancellation()
+    {
+        using var lar = new LibArchiveReader("7ztest.7z");
+        using var cts = new CancellationTokenSource();
+        cts.Cancel();
+        Assert.CatchAsync<OperationCanceledException>(async () =>
+        {
+            await foreach (var _ in lar.EntriesAsync(cts.Token))
+            {
+            }
+        });
+    }
+
+    [Test]
+    public void ListReturnsMetadata()
+    {
+        using var lar = new LibArchiveReader("7ztest.7z");
+        var entries = lar.List();
+        CollectionAssert.AreEqual(new[] { "subdir/", "empty", "subdir/empty", "1gzero", "1krandom" }, entries.Select(e => e.Name));
+        Assert.AreEqual(EntryType.Directory, entries[0].Type);
+        Assert.AreEqual(EntryType.File, entries[3].Type);
+        Assert.AreEqual(1L << 30, entries[3].Size);
+        Assert.AreEqual(1024, entries[4].Size);
+        Assert.AreEqual(2022, entries[4].LastModified?.Year);
+        Assert.IsNull(entries[4].SymlinkTarget);
+    }
+
+    [Test]
+    public void EntryMetadataIsLazy()
+    {
+        using var lar = new LibArchiveReader("7ztest.7z");
+        var entries = new List<LibArchiveReader.Entry>();
+        foreach (var e in lar.Entries())
+        {
+            Assert.IsTrue(e.PathUtf8.SequenceEqual(Encoding.UTF8.GetBytes(e.Name)));
+            Assert.IsTrue(e.SizeIsSet);
+            if (e.Name == "1krandom")
+            {
+                Assert.AreEqual(1024, e.Size);
+                Assert.AreEqual(EntryType.File, e.Type);
+            }
+            entries.Add(e);
+        }
+        Assert.AreEqual("subdir/", entries[0].Name);
+        Assert.Throws<InvalidOperationException>(() => _ = entries[0].Size);
+    }
+
+    [Test]
+    public void StreamErrorsPropagate()
+    {
+        var data = File.ReadAllBytes("7ztest.7z");
+        // The Stream's own exception surfaces as it is, not wrapped or replaced by libarchive's report
+        var failure = new IOException("The source failed");
+        var e = Assert.Throws<IOException>(() =>
+        {
+            using var lar = new LibArchiveReader(new FailingStream(data, data.Length / 2, failure), 4096);
+            Hashes(lar);
+        });
+        Assert.AreSame(failure, e);
+
+        using var truncated = new MemoryStream(data, 0, data.Length / 2);
+        Assert.Throws<ArchiveException>(() =>
+        {
+            using var lar = new LibArchiveReader(truncated);
+            Hashes(lar);
+        });
+    }
+
+    [Test]
+    public async Task PipelinedMatchesSequential()
+    {
+        using var lar = new LibArchiveReader("7ztest.7z");
+        using var hash = IncrementalHash.CreateHash(HashAlgorithmName.SHA256);
+        StringBuilder sb = new();
+        await foreach (var chunk in lar.ReadPipelined(64 << 10, 2).ReadAllAsync())
+        {
+            hash.AppendData(chunk.Data.Span);
+            if (chunk.IsLast)
+                sb.Append(chunk.Entry.Name).Append(' ').AppendLine(Convert.ToHexString(hash.GetHashAndReset()));
+        }
+        Assert.AreEqual(Hashes("7ztest.7z"), sb.ToString());
+    }
+
+    [Test]
+    public void PipelinedCancellationCompletes()
+    {
+        using var cts = new CancellationTokenSource();
+        Assert.CatchAsync<OperationCanceledException>(async () =>
+        {
+            using var lar = new LibArchiveReader("7ztest.7z");
+            await foreach (var _ in lar.ReadPipelined(cancellationToken: cts.Token).ReadAllAsync())
+                cts.Cancel();
+        });
+    }
+
+    [Test]
+    public void ProcessReadsWantedEntriesInOnePass()
+    {
+        using var temp = new TempDirectory();
+        var path = temp["test.7z"];
+        var random = new Random(3);
+        var files = new Dictionary<string, byte[]>();
+        using (var writer = new LibArchiveWriter(path, ArchiveFormat.SevenZip))
+            for (var i = 0; i < 40; i++)
+            {
+                var data = new byte[random.Next(1000, 20_000)];
+                random.NextBytes(data.AsSpan(0, data.Length / 3));
+                files[$"dir/file{i}"] = data;
+                writer.AddFile($"dir/file{i}", data);
+            }
+
+        using var lar = new LibArchiveReader(path);
+        var wanted = new[] { "dir/file30", "dir/file3", "dir/file17", "dir/file3" };
+        var got = new Dictionary<string, byte[]>();
+        Assert.AreEqual(3, lar.Process(wanted, e => got.Add(e.Name, e.ReadAllBytes())));
+        CollectionAssert.AreEquivalent(wanted.Distinct(), got.Keys);
+        foreach (var (name, data) in got)
+            CollectionAssert.AreEqual(files[name], data, name);
+        // Stopped at the last wanted entry, so enumeration carries on after it
+        Assert.AreEqual(31, lar.Statistics.Headers);
+        Assert.AreEqual("dir/file31", lar.Entries().First().Name);
+
+        using var again = new LibArchiveReader(path);
+        Assert.AreEqual(1, again.Process(new[] { "dir/file5", "no/such/file" }, _ => { }));
+    }
+
+    [Test]
+    public void OpenSplitVolumes()
+    {
+        var data = File.ReadAllBytes("7ztest.7z");
+        var cuts = new[] { 0, 1000, data.Length / 2, data.Length / 2, data.Length };
+        var parts = Enumerable.Range(0, cuts.Length - 1).Select(i => data[cuts[i]..cuts[i + 1]]).ToList();
+        using var temp = new TempDirectory();
+        var names = parts.Select((_, i) => temp[$"test.7z.{i + 1:D3}"]).ToList();
+        for (var i = 0; i < parts.Count; i++)
+            File.WriteAllBytes(names[i], parts[i]);
+        using (var lar = new LibArchiveReader(names, 4096))
+            Assert.AreEqual(Hashes("7ztest.7z"), Hashes(lar));
+
+        using (var lar = new LibArchiveReader(parts.Select(p => new MemoryStream(p))))
+            Assert.AreEqual(Hashes("7ztest.7z"), Hashes(lar));
+        Assert.Throws<FileNotFoundException>(() => _ = new LibArchiveReader(new[] { temp["missing.7z.001"] }));
+    }
+
+    private static string Hashes(string filename)
+    {
+        using var lar = new LibArchiveReader(filename);
+        return Hashes(lar);
+    }
+
+    private static string Hashes(LibArchiveReader lar)
+    {
+        using var hash = SHA256.Create();
+        StringBuilder sb = new();
+        foreach (var e in lar.Entries())
+        {
+            using var s = e.Stream;
+            sb.Append(e.Name).Append(' ').AppendLine(Convert.ToHexString(hash.ComputeHash(s)));
+        }
+        return sb.ToString();
+    }
+
+    /// <summary>
+    /// A MemoryStream which throws failure once reading reaches offset
+    /// </summary>
+    private sealed class FailingStream : MemoryStream
+    {
+        private readonly int _offset;
+        private readonly Exception _failure;
+
+        public FailingStream(byte[] data, int offset, Exception failure) : base(data, false)
+        {
+            _offset = offset;
+            _failure = failure;
+        }
+
+        public override int Read(byte[] buffer, int offset, int count)
+        {
+            if (Position >= _offset)
+                throw _failure;
+            return base.Read(buffer, offset, Math.Min(count, _offset - (int)Position));
+        }
+    }
+}
@@ -0,0 +1,145 @@
+using System.IO.Compression;
+using System.Security.Cryptography;
+using LibArchive.Net;
+
+namespace Test.LibArchive.Net;
+
+public class ErrorPolicyTests
+{
+    [Test]
+    public void DamagedHeadersAreReadPastUnlessStrict()
+    {
+        var tar = DamagedTar();
+        using (var strict = new LibArchiveReader(tar))
+        {
+            var e = Assert.Throws<ArchiveException>(() => strict.Entries().ToList());
+            Assert.AreEqual(ArchiveResult.Retry, e!.Result);
+            Assert.IsTrue(e.Message.Contains("Damaged"), e.Message);
+        }
+
+        using var lar = new LibArchiveReader(tar, new ReaderOptions { ErrorPolicy = ErrorPolicy.ContinueOnWarning });
+        CollectionAssert.AreEqual(new[] { "f0", "f2" }, lar.Entries().Select(entry => entry.Name));
+        Assert.Greater(lar.Statistics.Warnings, 0);
+    }
+
+    [Test]
+    public void TryNextEntryReportsEveryResult()
+    {
+        using var lar = new LibArchiveReader(DamagedTar());
+        var names = new List<string>();
+        var retries = 0;
+        ArchiveResult r;
+        while ((r = lar.TryNextEntry(out var entry)) != ArchiveResult.Eof)
+        {
+            if (r == ArchiveResult.Ok)
+                names.Add(entry!.Name);
+            else
+            {
+                Assert.AreEqual(ArchiveResult.Retry, r);
+                Assert.IsNull(entry);
+                Assert.IsTrue(lar.ErrorMessage!.Contains("Damaged"), lar.ErrorMessage);
+                retries++;
+            }
+        }
+        CollectionAssert.AreEqual(new[] { "f0", "f2" }, names);
+        Assert.Greater(retries, 0);
+    }
+
+    [Test]
+    public void FailedDataLeavesTheNextEntryReadable()
+    {
+        using var ms = new MemoryStream();
+        using (var zip = new ZipArchive(ms, ZipArchiveMode.Create, true))
+            foreach (var name in new[] { "bad", "good" })
+            {
+                using var s = zip.CreateEntry(name, CompressionLevel.NoCompression).Open();
+                s.Write(new byte[100]);
+            }
+        var data = ms.ToArray();
+        // Give the first entry compression method 7, which libarchive does not support, in both its
+        // local header and its central directory record
+        data[8] = 7;
+        data[data.AsSpan().IndexOf(new byte[] { 0x50, 0x4B, 1, 2 }) + 10] = 7;
+
+        using var lar = new LibArchiveReader(data, new ReaderOptions { ErrorPolicy = ErrorPolicy.SkipFailedEntries });
+        var results = new List<string>();
+        foreach (var e in lar.Entries())
+        {
+            var r = e.TryReadInto(new byte[200], out var read);
+            results.Add($"{e.Name} {r} {read}");
+        }
+        CollectionAssert.AreEqual(new[] { "bad Failed 0", "good Ok 100" }, results);
+
+        using var strict = new LibArchiveReader(data);
+        var first = strict.Entries().First();
+        var error = Assert.Throws<ArchiveException>(() => first.ReadAllBytes());
+        Assert.AreEqual(ArchiveResult.Failed, error!.Result);
+        Assert.AreEqual(100, strict.Entries().Select(e => e.ReadAllBytes().Length).Single());
+    }
+
+    [Test]
+    public void ToleratedDataWarningsKeepTheirBlocks()
+    {
+        var expected = Enumerable.Range(0, 100_000).Select(i => (byte)(i % 251)).ToArray();
+        using var ms = new MemoryStream();
+        using (var zip = new ZipArchive(ms, ZipArchiveMode.Create, true))
+        using (var s = zip.CreateEntry("crc", CompressionLevel.Optimal).Open())
+            s.Write(expected);
+        var data = ms.ToArray();
+        // Give the entry a wrong CRC in both its local header and its central directory record, so
+        // that libarchive warns of it along with the last block of data
+        data[14] ^= 0xFF;
+        data[data.AsSpan().IndexOf(new byte[] { 0x50, 0x4B, 1, 2 }) + 16] ^= 0xFF;
+
+        var tolerant = new ReaderOptions { ErrorPolicy = ErrorPolicy.ContinueOnWarning };
+        using (var lar = new LibArchiveReader(data, tolerant))
+            foreach (var e in lar.Entries())
+            {
+                using var copy = new MemoryStream();
+                e.Stream.CopyTo(copy);
+                Assert.AreEqual(expected.Length, copy.Length);
+                CollectionAssert.AreEqual(expected, copy.ToArray());
+                Assert.AreEqual(1, lar.Statistics.Warnings);
+            }
+        using (var lar = new LibArchiveReader(data, tolerant))
+            foreach (var e in lar.Entries())
+                CollectionAssert.AreEqual(SHA256.HashData(expected), e.ComputeHash(HashAlgorithmName.SHA256));
+
+        using var strict = new LibArchiveReader(data);
+        var entry = strict.Entries().First();
+        var error = Assert.Throws<ArchiveException>(() => entry.Stream.CopyTo(Stream.Null));
+        Assert.AreEqual(ArchiveResult.Warn, error!.Result);
+    }
+
+    [Test]
+    public void TryOpenReportsFailure()
+    {
+        Assert.AreEqual(ArchiveResult.Fatal, LibArchiveReader.TryOpen("no-such-file.tar", out var missing));
+        Assert.IsNull(missing);
+        Assert.AreEqual(ArchiveResult.Ok, LibArchiveReader.TryOpen("sparse.tar", out var lar));
+        using (lar)
+            Assert.AreEqual("sparse", lar!.Entries().Select(e => e.Name).Single());
+        Assert.Throws<ObjectDisposedException>(() => _ = lar.ErrorMessage);
+        Assert.Throws<ObjectDisposedException>(() => _ = lar.ErrorNumber);
+
+        var e = Assert.Throws<ArchiveException>(() => new LibArchiveReader("no-such-file.tar"));
+        Assert.AreEqual(ArchiveResult.Fatal, e!.Result);
+        Assert.AreEqual(2, e.ErrorNumber); // ENOENT
+    }
+
+    /// <summary>
+    /// A tar of f0, f1 and f2 with f1's header corrupted. Data is non-zero so that
+    /// libarchive, hunting for the next header, does not take it for the end of the archive.
+    /// </summary>
+    private static byte[] DamagedTar()
+    {
+        using var ms = new MemoryStream();
+        using (var writer = new LibArchiveWriter(ms, ArchiveFormat.Tar, leaveOpen: true))
+            for (var i = 0; i < 3; i++)
+                writer.AddFile($"f{i}", Enumerable.Repeat((byte)'x', 1024).ToArray());
+        var data = ms.ToArray();
+        // One header block and two data blocks per entry
+        data[1536] ^= 0xFF;
+        return data;
+    }
+}
@@ -0,0 +1,105 @@
+using System.Text;
+using LibArchive.Net;
+
+namespace Test.LibArchive.Net;
+
+public class ExtractTests : TempDirectoryTests
+{
+    [TestCase(false)]
+    [TestCase(true)]
+    public void ExtractsFilesDirectoriesAndTimes(bool preallocate)
+    {
+        var stamp = DateTimeOffset.FromUnixTimeSeconds(1_500_000_000);
+        var archive = Write(w =>
+        {
+            w.AddDirectory("dir", stamp, 0x1C0);
+            w.AddFile("dir/a.txt", Encoding.ASCII.GetBytes("hello"), stamp, 0x180);
+            w.AddFile("/absolute.bin", new byte[70_000], stamp);
+            w.AddFile("empty", ReadOnlySpan<byte>.Empty, stamp);
+        });
+        using (var lar = new LibArchiveReader(archive))
+            lar.ExtractTo(Path.Combine(Dir, "out"), new ExtractOptions { Preallocate = preallocate });
+
+        var root = Path.Combine(Dir, "out");
+        Assert.AreEqual("hello", File.ReadAllText(Path.Combine(root, "dir", "a.txt")));
+        Assert.AreEqual(70_000, new FileInfo(Path.Combine(root, "absolute.bin")).Length);
+        Assert.AreEqual(0, new FileInfo(Path.Combine(root, "empty")).Length);
+        Assert.AreEqual(stamp.UtcDateTime, File.GetLastWriteTimeUtc(Path.Combine(root, "dir", "a.txt")));
+        Assert.AreEqual(stamp.UtcDateTime, Directory.GetLastWriteTimeUtc(Path.Combine(root, "dir")));
+    }
+
+    [TestCase(false)]
+    [TestCase(true)]
+    public void NonAsciiPathsAreKept(bool preallocate)
+    {
+        var archive = Write(w => w.AddFile("dir/name-AB.txt", Encoding.ASCII.GetBytes("hello")));
+        // Rename the entry to dir/name-é.txt in UTF-8, which the writer cannot be given under the C
+        // locale, and fix the header's checksum to match
+        Encoding.UTF8.GetBytes("é").CopyTo(archive, archive.AsSpan(0, 100).IndexOf(Encoding.ASCII.GetBytes("AB")));
+        var sum = 8 * ' ';
+        for (var i = 0; i < 512; i++)
+            sum += i is >= 148 and < 156 ? 0 : archive[i];
+        Encoding.ASCII.GetBytes(Convert.ToString(sum, 8).PadLeft(6, '0') + "\0 ").CopyTo(archive, 148);
+
+        var root = Path.Combine(Dir, "répertoire");
+        using (var lar = new LibArchiveReader(archive))
+            lar.ExtractTo(root, new ExtractOptions { Preallocate = preallocate });
+        Assert.AreEqual("hello", File.ReadAllText(Path.Combine(root, "dir", "name-é.txt")));
+    }
+
+    [Test]
+    public void ExtractsSparseFiles()
+    {
+        using (var lar = new LibArchiveReader("sparse.tar"))
+            lar.ExtractTo(Dir);
+        var bytes = File.ReadAllBytes(Path.Combine(Dir, "sparse"));
+        Assert.AreEqual(1048580, bytes.Length);
+        Assert.AreEqual("head", Encoding.ASCII.GetString(bytes, 0, 4));
+        Assert.AreEqual("tail", Encoding.ASCII.GetString(bytes, bytes.Length - 4, 4));
+    }
+
+    [Test]
+    public void SecurePathsRejectDotDot()
+    {
+        var archive = Write(w => w.AddFile("a/../../escaped", new byte[1]));
+        using (var lar = new LibArchiveReader(archive))
+            Assert.Throws<ArchiveException>(() => lar.ExtractTo(Path.Combine(Dir, "out")));
+        Assert.IsFalse(File.Exists(Path.Combine(Dir, "escaped")));
+    }
+
+    [Test]
+    public void TargetBehindSymlinkIsAllowed()
+    {
+        if (OperatingSystem.IsWindows())
+            Assert.Ignore("Symlinks need privileges on Windows");
+        Directory.CreateDirectory(Path.Combine(Dir, "real"));
+        Directory.CreateSymbolicLink(Path.Combine(Dir, "link"), Path.Combine(Dir, "real"));
+        using (var lar = new LibArchiveReader("sparse.tar"))
+            lar.ExtractTo(Path.Combine(Dir, "link", "out"));
+        Assert.IsTrue(File.Exists(Path.Combine(Dir, "real", "out", "sparse")));
+    }
+
+    [TestCase(false)]
+    [TestCase(true)]
+    public void NoOverwriteKeepsExistingFiles(bool preallocate)
+    {
+        File.WriteAllText(Path.Combine(Dir, "sparse"), "existing");
+        using (var lar = new LibArchiveReader("sparse.tar"))
+            lar.ExtractTo(Dir, new ExtractOptions { Overwrite = false, Preallocate = preallocate });
+        Assert.AreEqual("existing", File.ReadAllText(Path.Combine(Dir, "sparse")));
+        using (var lar = new LibArchiveReader("sparse.tar"))
+            lar.ExtractTo(Dir, new ExtractOptions { Preallocate = preallocate });
+        Assert.AreEqual(1048580, new FileInfo(Path.Combine(Dir, "sparse")).Length);
+    }
+
+    private static byte[] Write(Action<LibArchiveWriter> add)
+    {
+        using var ms = new MemoryStream();
+        using (var writer = new LibArchiveWriter(ms, ArchiveFormat.Tar, leaveOpen: true))
+        {
+            add(writer);
+            writer.Finish();
+        }
+        return ms.ToArray();
+    }
+}
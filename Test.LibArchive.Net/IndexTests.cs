@@ -0,0 +1,102 @@
+using LibArchive.Net;
+
+namespace Test.LibArchive.Net;
+
+public class IndexTests : TempDirectoryTests
+{
+    [TestCase(ArchiveFormat.Zip, ArchiveFilter.None, true)]
+    [TestCase(ArchiveFormat.Tar, ArchiveFilter.None, true)]
+    [TestCase(ArchiveFormat.Cpio, ArchiveFilter.None, true)]
+    [TestCase(ArchiveFormat.Tar, ArchiveFilter.Gzip, false)]
+    public void OpenEntryReadsEachFile(ArchiveFormat format, ArchiveFilter filter, bool seeks)
+    {
+        var (path, files) = Write(format, filter);
+        using var lar = new LibArchiveReader(path);
+        Assert.AreEqual(seeks, lar.Index.SeeksToEntries);
+        Assert.AreEqual(files.Count + 1, lar.Index.Count);
+        foreach (var name in files.Keys.Reverse())
+        {
+            var e = lar.OpenEntry(name);
+            Assert.IsNotNull(e, name);
+            using var ms = new MemoryStream();
+            e!.Stream.CopyTo(ms);
+            CollectionAssert.AreEqual(files[name], ms.ToArray(), name);
+        }
+        Assert.IsNull(lar.OpenEntry("no/such/file"));
+    }
+
+    [Test]
+    public void SidecarIsReusedUntilTheArchiveChanges()
+    {
+        var (path, files) = Write(ArchiveFormat.Zip, ArchiveFilter.None);
+        var sidecar = path + ".index";
+        var built = ArchiveIndex.LoadOrBuild(path);
+        Assert.IsTrue(File.Exists(sidecar));
+        var written = File.GetLastWriteTimeUtc(sidecar);
+
+        var loaded = ArchiveIndex.LoadOrBuild(path);
+        Assert.AreEqual(written, File.GetLastWriteTimeUtc(sidecar));
+        CollectionAssert.AreEquivalent(built.Names, loaded.Names);
+        Assert.IsTrue(loaded.SeeksToEntries);
+        using (var lar = new LibArchiveReader(path) { Index = loaded })
+        {
+            using var ms = new MemoryStream();
+            lar.OpenEntry("dir/file3.bin")!.Stream.CopyTo(ms);
+            CollectionAssert.AreEqual(files["dir/file3.bin"], ms.ToArray());
+        }
+
+        File.SetLastWriteTimeUtc(path, DateTime.UtcNow.AddMinutes(1));
+        Assert.IsFalse(loaded.IsCurrent(path));
+        using (var stale = new LibArchiveReader(path))
+            Assert.Throws<ArgumentException>(() => stale.Index = loaded);
+        Assert.IsTrue(ArchiveIndex.LoadOrBuild(path).IsCurrent(path));
+
+        File.WriteAllText(sidecar, "not an index");
+        Assert.Throws<InvalidDataException>(() => ArchiveIndex.Load(sidecar));
+        Assert.IsTrue(ArchiveIndex.LoadOrBuild(path).IsCurrent(path));
+
+        // The entry count follows the magic, version, length, write time, format and seek flag
+        var saved = File.ReadAllBytes(sidecar);
+        foreach (var count in new[] { -1, int.MaxValue })
+        {
+            BitConverter.GetBytes(count).CopyTo(saved, 4 + 4 + 8 + 8 + 4 + 1);
+            File.WriteAllBytes(sidecar, saved);
+            Assert.Throws<InvalidDataException>(() => ArchiveIndex.Load(sidecar));
+            Assert.IsTrue(ArchiveIndex.LoadOrBuild(path).IsCurrent(path));
+        }
+    }
+
+    [Test]
+    public void SevenZipFallsBackToSkipping()
+    {
+        using var lar = new LibArchiveReader("7ztest.7z");
+        Assert.IsFalse(lar.Index.SeeksToEntries);
+        Assert.AreEqual(0, lar.OpenEntry("subdir/empty")!.Size);
+        Assert.AreEqual(EntryType.Directory, lar.OpenEntry("subdir/")!.Type);
+    }
+
+    [Test]
+    public void LookupNeedsAFile()
+    {
+        using var lar = new LibArchiveReader(File.ReadAllBytes("7ztest.7z"));
+        Assert.Throws<InvalidOperationException>(() => lar.OpenEntry("empty"));
+    }
+
+    private (string, Dictionary<string, byte[]>) Write(ArchiveFormat format, ArchiveFilter filter)
+    {
+        var random = new Random(5);
+        var files = new Dictionary<string, byte[]>();
+        var path = Path.Combine(Dir, $"test.{format}");
+        using var writer = new LibArchiveWriter(path, format, filter);
+        writer.AddDirectory("dir");
+        for (var i = 0; i < 8; i++)
+        {
+            var data = new byte[random.Next(0, 100_000)];
+            random.NextBytes(data.AsSpan(0, data.Length / 2));
+            files[$"dir/file{i}.bin"] = data;
+            writer.AddFile($"dir/file{i}.bin", data);
+        }
+        writer.Finish();
+        return (path, files);
+    }
+}
@@ -0,0 +1,98 @@
+using System.IO.Compression;
+using LibArchive.Net;
+
+namespace Test.LibArchive.Net;
+
+public class ReaderOptionsTests
+{
+    private static readonly ReaderOptions TarOnly = new() { Formats = ReadFormats.Tar, Filters = ReadFilters.None };
+
+    [Test]
+    public void RestrictedFormatsStillRead()
+    {
+        using var lar = new LibArchiveReader("sparse.tar", options: TarOnly);
+        CollectionAssert.AreEqual(new[] { "sparse" }, lar.Entries().Select(e => e.Name).ToList());
+    }
+
+    [Test]
+    public void UnregisteredFormatsAndFiltersAreRejected()
+    {
+        Assert.Throws<ArchiveException>(() =>
+        {
+            using var lar = new LibArchiveReader("7ztest.7z", options: TarOnly);
+            lar.List();
+        });
+        Assert.Throws<ArchiveException>(() =>
+        {
+            using var lar = new LibArchiveReader(Gzip(File.ReadAllBytes("sparse.tar")), TarOnly);
+            lar.List();
+        });
+
+        using var gz = new LibArchiveReader(Gzip(File.ReadAllBytes("sparse.tar")), new ReaderOptions { Formats = ReadFormats.Tar, Filters = ReadFilters.Gzip });
+        Assert.AreEqual(1, gz.List().Length);
+    }
+
+    [Test]
+    public void RawReadsBareCompressedStream()
+    {
+        var data = new byte[100_000];
+        new Random(5).NextBytes(data);
+        using var lar = new LibArchiveReader(Gzip(data), new ReaderOptions { Formats = ReadFormats.Raw, Filters = ReadFilters.Gzip });
+        foreach (var e in lar.Entries())
+        {
+            using var ms = new MemoryStream();
+            e.Stream.CopyTo(ms);
+            Assert.AreEqual("data", e.Name);
+            CollectionAssert.AreEqual(data, ms.ToArray());
+        }
+    }
+
+    [Test]
+    public void ReadAllBytesWithoutRecordedSize()
+    {
+        var data = new byte[300_000];
+        new Random(6).NextBytes(data);
+        var options = new ReaderOptions { Formats = ReadFormats.Raw, Filters = ReadFilters.Gzip };
+        using (var lar = new LibArchiveReader(Gzip(data), options))
+            foreach (var e in lar.Entries())
+            {
+                Assert.IsFalse(e.SizeIsSet);
+                Assert.Throws<NotSupportedException>(() => _ = e.Stream.Length);
+                CollectionAssert.AreEqual(data, e.ReadAllBytes());
+            }
+        using (var lar = new LibArchiveReader(Gzip(data), options))
+            foreach (var e in lar.Entries())
+            {
+                using var pooled = e.ReadPooled();
+                CollectionAssert.AreEqual(data, pooled.Memory.ToArray());
+            }
+    }
+
+    [Test]
+    public void ReadConcatenatedArchives()
+    {
+        var tar = File.ReadAllBytes("sparse.tar");
+        var twice = tar.Concat(tar).ToArray();
+        using (var lar = new LibArchiveReader(twice, TarOnly))
+            Assert.AreEqual(1, lar.List().Length);
+        using (var lar = new LibArchiveReader(twice, new ReaderOptions { Formats = ReadFormats.Tar, ReadConcatenatedArchives = true }))
+            Assert.AreEqual(2, lar.List().Length);
+    }
+
+    [Test]
+    public void OptionsMustBeAccepted()
+    {
+        Assert.Throws<ArchiveException>(() => new LibArchiveReader("7ztest.7z", options: new ReaderOptions { Formats = ReadFormats.SevenZip, HeaderCharset = "CP437" }));
+        Assert.Throws<ArchiveException>(() => new LibArchiveReader("sparse.tar", options: new ReaderOptions { Formats = ReadFormats.Tar, IgnoreZipCrc32 = true }));
+        using var lar = new LibArchiveReader("sparse.tar", options: new ReaderOptions { HeaderCharset = "CP437", IgnoreZipCrc32 = true });
+        Assert.AreEqual(1, lar.List().Length);
+    }
+
+    private static byte[] Gzip(byte[] data)
+    {
+        using var ms = new MemoryStream();
+        using (var gz = new GZipStream(ms, CompressionLevel.Fastest, true))
+            gz.Write(data);
+        return ms.ToArray();
+    }
+}
@@ -0,0 +1,66 @@
+using LibArchive.Net;
+
+namespace Test.LibArchive.Net;
+
+public class ReaderPoolTests
+{
+    [Test]
+    public void PooledReadersMatchUnpooled()
+    {
+        var tar = File.ReadAllBytes("sparse.tar");
+        using var pool = new LibArchiveReaderPool(new ReaderOptions { Formats = ReadFormats.Tar, Filters = ReadFilters.None }, 4096, 4);
+        for (var i = 0; i < 50; i++)
+        {
+            using var reader = (i % 3) switch
+            {
+                0 => pool.Open("sparse.tar"),
+                1 => pool.Open(new MemoryStream(tar)),
+                _ => pool.Open(tar)
+            };
+            foreach (var e in reader.Entries())
+            {
+                Assert.AreEqual("sparse", e.Name);
+                using var ms = new MemoryStream();
+                e.Stream.CopyTo(ms);
+                Assert.AreEqual(1048580, ms.Length);
+            }
+        }
+    }
+
+    [Test]
+    public void ConcurrentOpens()
+    {
+        var data = File.ReadAllBytes("7ztest.7z");
+        using var pool = new LibArchiveReaderPool(new ReaderOptions { Formats = ReadFormats.SevenZip }, retain: 2);
+        var names = new string[64];
+        Parallel.For(0, names.Length, i =>
+        {
+            using var reader = i % 2 == 0 ? pool.Open(data) : pool.Open(new MemoryStream(data));
+            names[i] = string.Join(",", reader.List().Select(e => e.Name));
+        });
+        Assert.AreEqual(1, names.Distinct().Count());
+        Assert.AreEqual("subdir/,empty,subdir/empty,1gzero,1krandom", names[0]);
+    }
+
+    [Test]
+    public void FailuresLeaveThePoolUsable()
+    {
+        using var pool = new LibArchiveReaderPool(new ReaderOptions { Formats = ReadFormats.Tar }, retain: 1);
+        Assert.Throws<ArchiveException>(() =>
+        {
+            using var reader = pool.Open(File.ReadAllBytes("7ztest.7z"));
+            reader.List();
+        });
+        using (var reader = pool.Open("sparse.tar"))
+            Assert.AreEqual(1, reader.List().Length);
+
+        pool.Dispose();
+        Assert.Throws<ObjectDisposedException>(() => pool.Open("sparse.tar"));
+    }
+
+    [Test]
+    public void InvalidOptionsThrowOnConstruction()
+    {
+        Assert.Throws<ArchiveException>(() => new LibArchiveReaderPool(new ReaderOptions { Formats = ReadFormats.SevenZip, HeaderCharset = "CP437" }));
+    }
+}
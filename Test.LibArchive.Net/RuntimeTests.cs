@@ -0,0 +1,15 @@
+using LibArchive.Net;
+
+namespace Test.LibArchive.Net;
+
+public class RuntimeTests
+{
+    [Test]
+    public void PreloadFindsTheBundledLibrary()
+    {
+        Assert.GreaterOrEqual(LibArchiveRuntime.Preload(), 3_000_000);
+        Assert.IsNotNull(LibArchiveRuntime.LibraryPath);
+        Assert.IsTrue(File.Exists(LibArchiveRuntime.LibraryPath));
+        Assert.IsTrue(LibArchiveRuntime.LibraryPath!.StartsWith(AppContext.BaseDirectory));
+    }
+}
@@ -0,0 +1,138 @@
+using System.IO.Compression;
+using LibArchive.Net;
+
+namespace Test.LibArchive.Net;
+
+public class SeekableTests : TempDirectoryTests
+{
+    [TestCase(ArchiveFormat.Tar, ArchiveFilter.None, false)]
+    [TestCase(ArchiveFormat.Cpio, ArchiveFilter.None, false)]
+    [TestCase(ArchiveFormat.Tar, ArchiveFilter.Zstd, false)]
+    [TestCase(ArchiveFormat.Zip, ArchiveFilter.None, false)]
+    [TestCase(ArchiveFormat.Zip, ArchiveFilter.None, true)]
+    [TestCase(ArchiveFormat.Tar, ArchiveFilter.None, true)]
+    public void RandomReadsMatchTheData(ArchiveFormat format, ArchiveFilter filter, bool fromMemory)
+    {
+        var random = new Random(7);
+        var files = new Dictionary<string, byte[]>();
+        var path = Path.Combine(Dir, "test.archive");
+        using (var writer = new LibArchiveWriter(path, format, filter))
+            for (var i = 0; i < 3; i++)
+            {
+                var data = new byte[300_000 + i];
+                random.NextBytes(data);
+                files[$"file{i}"] = data;
+                writer.AddFile($"file{i}", data);
+            }
+
+        using var lar = fromMemory ? new LibArchiveReader(File.ReadAllBytes(path)) : new LibArchiveReader(path);
+        var streams = lar.Entries().Select(e => (e.Name, Stream: e.OpenSeekable(1 << 16))).ToList();
+        Assert.AreEqual(files.Count, streams.Count);
+        foreach (var (name, stream) in streams)
+            using (stream)
+            {
+                var data = files[name];
+                Assert.IsTrue(stream.CanSeek);
+                Assert.AreEqual(data.Length, stream.Length);
+                foreach (var at in new[] { 250_000, 10, 200_000, 299_990, 0, 123_456 })
+                {
+                    stream.Position = at;
+                    var buffer = new byte[20_000];
+                    var read = stream.Read(buffer);
+                    Assert.Greater(read, 0);
+                    CollectionAssert.AreEqual(data.AsSpan(at, Math.Min(read, data.Length - at)).ToArray(), buffer.AsSpan(0, read).ToArray(), $"{name} at {at}");
+                }
+                stream.Seek(-5, SeekOrigin.End);
+                Assert.AreEqual(5, stream.Read(new byte[10]));
+                Assert.AreEqual(0, stream.Read(new byte[10]));
+            }
+    }
+
+    [TestCase(ArchiveFilter.None)]
+    [TestCase(ArchiveFilter.Zstd)]
+    public void StreamsOutliveTheReader(ArchiveFilter filter)
+    {
+        var data = new byte[300_000];
+        new Random(8).NextBytes(data);
+        var path = Path.Combine(Dir, "test.tar");
+        using (var writer = new LibArchiveWriter(path, ArchiveFormat.Tar, filter))
+            writer.AddFile("file", data);
+
+        Stream stream;
+        var lar = new LibArchiveReader(path);
+        using (lar)
+        {
+            stream = lar.Entries().First().OpenSeekable(1 << 16);
+            Assert.AreEqual(1000, stream.Read(new byte[1000]));
+        }
+        using (stream)
+        {
+            var buffer = new byte[1000];
+            Assert.AreEqual(1000, stream.Read(buffer));
+            CollectionAssert.AreEqual(data.AsSpan(1000, 1000).ToArray(), buffer);
+            // Past what was decoded while the reader was open, the stream goes on with one of its own
+            stream.Position = 250_000;
+            Assert.AreEqual(1000, stream.Read(buffer));
+            CollectionAssert.AreEqual(data.AsSpan(250_000, 1000).ToArray(), buffer);
+            Assert.IsTrue(lar.IsClosed);
+        }
+    }
+
+    [TestCase(ArchiveFilter.None, false)]
+    [TestCase(ArchiveFilter.None, true)]
+    [TestCase(ArchiveFilter.Zstd, false)]
+    public void OpenSeekableAfterPartialRead(ArchiveFilter filter, bool fromMemory)
+    {
+        var data = new byte[3_000_000];
+        new Random(9).NextBytes(data);
+        var path = Path.Combine(Dir, "test.tar");
+        using (var writer = new LibArchiveWriter(path, ArchiveFormat.Tar, filter))
+            writer.AddFile("file", data);
+
+        using var lar = fromMemory ? new LibArchiveReader(File.ReadAllBytes(path)) : new LibArchiveReader(path);
+        var e = lar.Entries().First();
+        // Past the first block read from the file, so that libarchive has moved on from the start of the data
+        Assert.AreEqual(1_500_000, e.ReadInto(new byte[1_500_000]));
+        using var stream = e.OpenSeekable(1 << 16);
+        var buffer = new byte[1000];
+        Assert.AreEqual(1000, stream.Read(buffer));
+        CollectionAssert.AreEqual(data.AsSpan(0, 1000).ToArray(), buffer);
+        stream.Position = 200_000;
+        Assert.AreEqual(1000, stream.Read(buffer));
+        CollectionAssert.AreEqual(data.AsSpan(200_000, 1000).ToArray(), buffer);
+    }
+
+    [Test]
+    public void ZipInsideCompressedTar()
+    {
+        using var zip = new MemoryStream();
+        using (var archive = new ZipArchive(zip, ZipArchiveMode.Create, true))
+            for (var i = 0; i < 20; i++)
+            {
+                using var s = archive.CreateEntry($"inner{i}.txt").Open();
+                s.Write(new byte[i * 1000]);
+            }
+        var path = Path.Combine(Dir, "outer.tar.gz");
+        using (var writer = new LibArchiveWriter(path, ArchiveFormat.Tar, ArchiveFilter.Gzip))
+        {
+            writer.AddFile("before.bin", new byte[100_000]);
+            writer.AddFile("inner.zip", zip.ToArray());
+        }
+
+        using var lar = new LibArchiveReader(path);
+        var inner = lar.Entries().First(e => e.Name == "inner.zip").OpenSeekable(4096);
+        using var read = new ZipArchive(inner);
+        Assert.AreEqual(20, read.Entries.Count);
+        Assert.AreEqual(19_000, read.Entries.Single(e => e.Name == "inner19.txt").Length);
+        using var ms = new MemoryStream();
+        read.Entries[3].Open().CopyTo(ms);
+        Assert.AreEqual(3000, ms.Length);
+    }
+
+    [Test]
+    public void StreamSourcesCannotReopen()
+    {
+        using var lar = new LibArchiveReader(File.OpenRead("7ztest.7z"));
+        Assert.Throws<InvalidOperationException>(() => lar.Entries().First(e => e.Name == "empty").OpenSeekable());
+    }
+}
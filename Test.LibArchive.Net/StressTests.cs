@@ -0,0 +1,223 @@
+using System.Diagnostics;
+using System.Diagnostics.Metrics;
+using LibArchive.Net;
+
+namespace Test.LibArchive.Net;
+
+/// <summary>
+/// Many readers at once, across formats and ways of opening, and Dispose racing reads on other
+/// threads. LIBARCHIVE_STRESS_READERS sets the readers per round (default 2000), and
+/// LIBARCHIVE_STRESS_SECONDS turns a single round into a soak lasting that long. CI leaves these
+/// out; run them with dotnet test --filter TestCategory=Stress.
+/// </summary>
+[Category("Stress")]
+[NonParallelizable]
+public class StressTests
+{
+    private static readonly int Readers = Setting("LIBARCHIVE_STRESS_READERS", 2000);
+    private static readonly int Seconds = Setting("LIBARCHIVE_STRESS_SECONDS", 0);
+
+    private TempDirectory _dir = null!;
+    private readonly List<(string Path, byte[] Data)> _archives = new();
+    private readonly Dictionary<string, byte[]> _files = new();
+    private long _size;
+
+    [OneTimeSetUp]
+    public void CreateArchives()
+    {
+        _dir = new TempDirectory();
+        var random = new Random(11);
+        for (var i = 0; i < 16; i++)
+        {
+            // Half random, half repetitive, so every decompressor has some work to do
+            var data = new byte[random.Next(1, 32 << 10)];
+            random.NextBytes(data.AsSpan(0, data.Length / 2));
+            _files[$"dir{i % 3}/file{i}"] = data;
+            _size += data.Length;
+        }
+
+        foreach (var (format, filter, extension) in new[]
+                 {
+                     (ArchiveFormat.Tar, ArchiveFilter.Gzip, "tar.gz"),
+                     (ArchiveFormat.Tar, ArchiveFilter.Zstd, "tar.zst"),
+                     (ArchiveFormat.Cpio, ArchiveFilter.Xz, "cpio.xz"),
+                     (ArchiveFormat.Zip, ArchiveFilter.None, "zip"),
+                     (ArchiveFormat.SevenZip, ArchiveFilter.None, "7z")
+                 })
+        {
+            var path = _dir[$"stress.{extension}"];
+            using (var writer = new LibArchiveWriter(path, format, filter))
+                foreach (var (name, data) in _files)
+                    writer.AddFile(name, data);
+            _archives.Add((path, File.ReadAllBytes(path)));
+        }
+    }
+
+    [OneTimeTearDown]
+    public void Cleanup()
+    {
+        _dir.Dispose();
+    }
+
+    [Test]
+    public void ParallelReadersLeakNothing()
+    {
+        long released = 0;
+        using var listener = Released(m => Interlocked.Add(ref released, m));
+        using var pool = new LibArchiveReaderPool();
+        // Warm up the thread pool, the reader pool and libarchive itself before taking the baseline
+        Round(pool, Readers / 10);
+        var (handles, native) = Resources();
+        var before = Interlocked.Read(ref released);
+
+        var latencies = new List<double>();
+        long bytes = 0;
+        var elapsed = Stopwatch.StartNew();
+        do
+        {
+            var (roundLatencies, roundBytes) = Round(pool, Readers);
+            latencies.AddRange(roundLatencies);
+            bytes += roundBytes;
+        } while (elapsed.Elapsed.TotalSeconds < Seconds);
+        elapsed.Stop();
+        // Each reader publishes its statistics as Dispose frees it, before any collection
+        var freed = Interlocked.Read(ref released) - before;
+
+        var (handlesAfter, nativeAfter) = Resources();
+        latencies.Sort();
+        Console.WriteLine($"{latencies.Count} readers, {bytes / elapsed.Elapsed.TotalSeconds / 1e9:F3} GB/s, " +
+                          $"open p50 {Percentile(latencies, 0.5):F3} ms p99 {Percentile(latencies, 0.99):F3} ms, " +
+                          $"native memory {(nativeAfter - native) / (1 << 20):+0;-0} MiB, handles {handlesAfter - handles:+0;-0}");
+        Assert.AreEqual(latencies.Count * _size, bytes);
+        Assert.GreaterOrEqual(freed, latencies.Count);
+        // A leaked reader holds a file descriptor or mapping as well as its libarchive handle
+        Assert.LessOrEqual(handlesAfter - handles, 8);
+    }
+
+    [Test]
+    public void DisposeDuringReadsIsSafe()
+    {
+        var big = new MemoryStream();
+        using (var writer = new LibArchiveWriter(big, ArchiveFormat.Tar, ArchiveFilter.Zstd, leaveOpen: true))
+            writer.AddFile("zeros", new byte[64 << 20]);
+
+        long released = 0;
+        using var listener = Released(m => Interlocked.Add(ref released, m));
+
+        const int iterations = 200;
+        var disposed = 0;
+        for (var i = 0; i < iterations; i++)
+        {
+            var lar = new LibArchiveReader(big.ToArray());
+            var stream = lar.Entries().First().Stream;
+            using var started = new ManualResetEventSlim();
+            var reading = Task.Factory.StartNew(() =>
+            {
+                var buffer = new byte[4096];
+                long total = stream.Read(buffer);
+                // Dispose now overlaps the reads that follow
+                started.Set();
+                try
+                {
+                    int r;
+                    while ((r = stream.Read(buffer)) > 0)
+                        total += r;
+                    return total;
+                }
+                catch (ObjectDisposedException)
+                {
+                    return -1;
+                }
+            }, TaskCreationOptions.LongRunning);
+            started.Wait();
+            lar.Dispose();
+            // Either a read saw the reader disposed, or the entry was read to the end first
+            var read = reading.Result;
+            if (read < 0)
+                disposed++;
+            else
+                Assert.AreEqual(64 << 20, read);
+            Assert.IsTrue(lar.IsClosed);
+            Assert.Throws<ObjectDisposedException>(() => stream.Read(new byte[16]));
+            Assert.Throws<ObjectDisposedException>(() => lar.Entries().ToList());
+        }
+
+        Console.WriteLine($"{disposed} of {iterations} readers disposed part-way through a read");
+        // Every handle was freed, once its last read returned
+        Assert.GreaterOrEqual(Interlocked.Read(ref released), iterations);
+    }
+
+    /// <summary>
+    /// Listen for readers being freed, through the libarchive.read.archives counter
+    /// </summary>
+    private static MeterListener Released(Action<long> freed)
+    {
+        var listener = new MeterListener();
+        listener.InstrumentPublished = (instrument, l) =>
+        {
+            if (instrument.Meter.Name == "LibArchive.Net" && instrument.Name == "libarchive.read.archives")
+                l.EnableMeasurementEvents(instrument);
+        };
+        listener.SetMeasurementEventCallback<long>((_, m, _, _) => freed(m));
+        listener.Start();
+        return listener;
+    }
+
+    /// <summary>
+    /// Open count readers in parallel, round-robin over the archives and ways of opening them, and
+    /// read every entry of each
+    /// </summary>
+    /// <returns>Each reader's open latency in milliseconds, and the bytes read</returns>
+    private (List<double> Latencies, long Bytes) Round(LibArchiveReaderPool pool, int count)
+    {
+        var latencies = new double[count];
+        long bytes = 0;
+        Parallel.For(0, count, new ParallelOptions { MaxDegreeOfParallelism = Math.Max(4, Environment.ProcessorCount * 2) }, i =>
+        {
+            var (path, data) = _archives[i % _archives.Count];
+            var start = Stopwatch.GetTimestamp();
+            using var lar = (i / _archives.Count % 6) switch
+            {
+                0 => new LibArchiveReader(path, 64 << 10),
+                1 => LibArchiveReader.OpenMapped(path),
+                2 => new LibArchiveReader(data),
+                3 => new LibArchiveReader(File.OpenRead(path), 64 << 10),
+                4 => LibArchiveReader.OpenPrefetched(path, 2, 64 << 10),
+                _ => pool.Open(data)
+            };
+            latencies[i] = (Stopwatch.GetTimestamp() - start) * 1000.0 / Stopwatch.Frequency;
+            var buffer = new byte[32 << 10];
+            long read = 0;
+            var entries = 0;
+            foreach (var e in lar.Entries())
+            {
+                int r;
+                while ((r = e.Stream.Read(buffer)) > 0)
+                    read += r;
+                entries++;
+            }
+            if (entries != _files.Count)
+                throw new InvalidDataException($"{path}: {entries} entries");
+            Interlocked.Add(ref bytes, read);
+        });
+        return (latencies.ToList(), bytes);
+    }
+
+    /// <summary>
+    /// OS handles held by the process, and its resident memory beyond the managed heap, once
+    /// everything collectable has been collected and finalized
+    /// </summary>
+    private static (int Handles, long Native) Resources()
+    {
+        GC.Collect();
+        GC.WaitForPendingFinalizers();
+        GC.Collect();
+        using var process = Process.GetCurrentProcess();
+        return (process.HandleCount, process.WorkingSet64 - GC.GetGCMemoryInfo().TotalCommittedBytes);
+    }
+
+    private static double Percentile(List<double> sorted, double p) => sorted[(int)Math.Min(sorted.Count - 1, sorted.Count * p)];
+
+    private static int Setting(string name, int fallback) =>
+        int.TryParse(Environment.GetEnvironmentVariable(name), out var value) ? value : fallback;
+}
@@ -0,0 +1,347 @@
+using System.Diagnostics.Metrics;
+using System.IO.Compression;
+using System.Security.Cryptography;
+using System.Text;
+using LibArchive.Net;
+
+namespace Test.LibArchive.Net;
+
+public class TarTests
+{
+    private const int SparseLength = 1048580;
+
+    [Test]
+    public void BlocksExposeSparseHoles()
+    {
+        using var lar = new LibArchiveReader("sparse.tar");
+        var seen = 0;
+        foreach (var e in lar.Entries())
+        {
+            seen++;
+            long end = 0, data = 0, holes = 0;
+            foreach (var block in e.ReadBlocks())
+            {
+                holes += block.Offset - end;
+                data += block.Data.Length;
+                end = block.Offset + block.Data.Length;
+            }
+            Assert.AreEqual(SparseLength, end);
+            Assert.AreEqual(SparseLength, data + holes);
+            Assert.Greater(holes, 0);
+        }
+        Assert.AreEqual(1, seen);
+    }
+
+    [Test]
+    public void CopyToFillsSparseHoles()
+    {
+        using var lar = new LibArchiveReader("sparse.tar");
+        var seen = 0;
+        foreach (var e in lar.Entries())
+        {
+            seen++;
+            using var ms = new MemoryStream();
+            e.Stream.CopyTo(ms);
+            var bytes = ms.ToArray();
+            Assert.AreEqual(SparseLength, bytes.Length);
+            Assert.AreEqual("head", Encoding.ASCII.GetString(bytes, 0, 4));
+            Assert.AreEqual("tail", Encoding.ASCII.GetString(bytes, SparseLength - 4, 4));
+            Assert.IsTrue(bytes.Skip(4).Take(SparseLength - 8).All(b => b == 0));
+        }
+        Assert.AreEqual(1, seen);
+    }
+
+    [Test]
+    public void CopyToAfterPartialReadCopiesTheRest()
+    {
+        byte[] expected;
+        using (var whole = new LibArchiveReader("sparse.tar"))
+            expected = whole.Entries().Select(e => e.ReadAllBytes()).Single();
+        using var lar = new LibArchiveReader("sparse.tar");
+        var seen = 0;
+        foreach (var e in lar.Entries())
+        {
+            seen++;
+            // Read through the entry rather than its stream, then copy what is left
+            Assert.AreEqual(4, e.ReadInto(new byte[4]));
+            using var ms = new MemoryStream();
+            e.Stream.CopyTo(ms);
+            CollectionAssert.AreEqual(expected.AsSpan(4).ToArray(), ms.ToArray());
+        }
+        Assert.AreEqual(1, seen);
+    }
+
+    [Test]
+    public void ComputeHashIncludesHoles()
+    {
+        byte[] data;
+        using (var lar = new LibArchiveReader("sparse.tar"))
+            data = lar.Entries().Select(e => e.ReadAllBytes()).Single();
+        var seen = 0;
+        using (var lar = new LibArchiveReader("sparse.tar"))
+            foreach (var e in lar.Entries())
+            {
+                seen++;
+                CollectionAssert.AreEqual(SHA256.HashData(data), e.ComputeHash(HashAlgorithmName.SHA256));
+            }
+
+        // After a partial read, only the rest is hashed
+        using (var lar = new LibArchiveReader("sparse.tar"))
+            foreach (var e in lar.Entries())
+            {
+                seen++;
+                Assert.AreEqual(10, e.Stream.Read(new byte[10]));
+                using var hash = IncrementalHash.CreateHash(HashAlgorithmName.SHA1);
+                e.AppendTo(hash);
+                CollectionAssert.AreEqual(SHA1.HashData(data.AsSpan(10)), hash.GetHashAndReset());
+            }
+        Assert.AreEqual(2, seen);
+    }
+
+    [Test]
+    public void KnownLengthAndPosition()
+    {
+        using var lar = new LibArchiveReader("sparse.tar");
+        var seen = 0;
+        foreach (var e in lar.Entries())
+        {
+            seen++;
+            var s = e.Stream;
+            Assert.AreEqual(SparseLength, s.Length);
+            Assert.AreEqual(0, s.Position);
+            var head = new byte[4];
+            Assert.AreEqual(4, e.ReadInto(head));
+            Assert.AreEqual("head", Encoding.ASCII.GetString(head));
+            Assert.AreEqual(4, s.Position);
+            Assert.AreEqual(100, s.Read(new byte[100]));
+            Assert.AreEqual(104, s.Position);
+            var rest = e.ReadAllBytes();
+            Assert.AreEqual(SparseLength - 104, rest.Length);
+            Assert.AreEqual(SparseLength, s.Position);
+            Assert.AreEqual("tail", Encoding.ASCII.GetString(rest, rest.Length - 4, 4));
+        }
+        Assert.AreEqual(1, seen);
+    }
+
+    [Test]
+    public void PipelinedErrorsComplete()
+    {
+        // A tar.gz cut off part-way through its data opens, then fails on the producer's side
+        var random = new byte[1 << 20];
+        new Random(7).NextBytes(random);
+        using var ms = new MemoryStream();
+        using (var writer = new LibArchiveWriter(ms, ArchiveFormat.Tar, ArchiveFilter.Gzip, leaveOpen: true))
+            writer.AddFile("random", random);
+        var truncated = ms.ToArray().AsMemory(0, (int)ms.Length / 2);
+        var delivered = 0L;
+        using (var lar = new LibArchiveReader(truncated))
+            Assert.ThrowsAsync<ArchiveException>(async () =>
+            {
+                await foreach (var chunk in lar.ReadPipelined(64 << 10, 2).ReadAllAsync())
+                    delivered += chunk.Data.Length;
+            });
+        Assert.Greater(delivered, 0);
+    }
+
+    [Test]
+    public void StatisticsArePublishedOnDispose()
+    {
+        using var compressed = new MemoryStream();
+        using (var gz = new GZipStream(compressed, CompressionLevel.Fastest, true))
+            gz.Write(File.ReadAllBytes("sparse.tar"));
+        var published = new Dictionary<string, double>();
+        using var listener = new MeterListener();
+        listener.InstrumentPublished = (instrument, l) =>
+        {
+            if (instrument.Meter.Name == "LibArchive.Net")
+                l.EnableMeasurementEvents(instrument);
+        };
+        listener.SetMeasurementEventCallback<long>((i, m, _, _) => published[i.Name] = published.GetValueOrDefault(i.Name) + m);
+        listener.SetMeasurementEventCallback<double>((i, m, _, _) => published[i.Name] = published.GetValueOrDefault(i.Name) + m);
+        listener.Start();
+
+        var lar = new LibArchiveReader(compressed.ToArray());
+        using (lar)
+        {
+            foreach (var e in lar.Entries())
+                e.Stream.CopyTo(Stream.Null);
+            var stats = lar.Statistics;
+            Assert.IsTrue(stats.Format.Contains("tar", StringComparison.OrdinalIgnoreCase), stats.Format);
+            Assert.AreEqual("gzip", stats.Filters);
+            Assert.AreEqual(compressed.Length, stats.CompressedBytes);
+            Assert.AreEqual(SparseLength, stats.UncompressedBytes);
+            Assert.AreEqual(1, stats.Headers);
+            Assert.Greater(stats.DataTime, TimeSpan.Zero);
+        }
+        Assert.Throws<ObjectDisposedException>(() => _ = lar.Statistics);
+
+        // Readers finalized meanwhile may add to the totals
+        Assert.GreaterOrEqual(published["libarchive.read.archives"], 1);
+        Assert.GreaterOrEqual(published["libarchive.read.uncompressed_bytes"], SparseLength);
+        Assert.GreaterOrEqual(published["libarchive.read.compressed_bytes"], compressed.Length);
+        Assert.Greater(published["libarchive.read.native_time"], 0);
+    }
+
+    [Test]
+    public void FiltersAreListedInnermostFirst()
+    {
+        using var xz = new MemoryStream();
+        using (var writer = new LibArchiveWriter(xz, ArchiveFormat.Tar, ArchiveFilter.Xz, leaveOpen: true))
+            writer.AddFile("f", new byte[10]);
+        using var compressed = new MemoryStream();
+        using (var gz = new GZipStream(compressed, CompressionLevel.Fastest, true))
+            gz.Write(xz.ToArray());
+
+        using var lar = new LibArchiveReader(compressed.ToArray());
+        Assert.AreEqual("f", lar.Entries().Select(e => e.Name).Single());
+        Assert.AreEqual("xz+gzip", lar.Statistics.Filters);
+    }
+
+    [Test]
+    [NonParallelizable]
+    public void ReuseEntriesAllocateNothingPerEntry()
+    {
+        using var tar = new MemoryStream();
+        using (var writer = new LibArchiveWriter(tar, ArchiveFormat.Tar, leaveOpen: true))
+            for (var i = 0; i < 2000; i++)
+                writer.AddFile($"f{i:D4}", new byte[i % 50]);
+
+        // A first pass JITs everything on the path and gets the runtime's own one-off allocations,
+        // such as starting the tiered JIT's background worker, out of the way of the second
+        Enumerate(tar.ToArray());
+        var (count, total, reused, allocated) = Enumerate(tar.ToArray());
+        Assert.IsTrue(reused);
+        Assert.AreEqual(2000, count);
+        Assert.AreEqual(2 * Enumerable.Range(0, 2000).Sum(i => i % 50), total);
+        Assert.AreEqual(0, allocated);
+    }
+
+    private static (int Count, long Total, bool Reused, long Allocated) Enumerate(byte[] tar)
+    {
+        using var lar = new LibArchiveReader(tar);
+        var buffer = new byte[100];
+        long allocated = 0, total = 0;
+        var count = 0;
+        var reused = true;
+        LibArchiveReader.Entry? first = null;
+        foreach (var e in lar.ReuseEntries())
+        {
+            // Everything allocated once is in place after the first entry
+            if (count++ == 1)
+                allocated = GC.GetAllocatedBytesForCurrentThread();
+            first ??= e;
+            var s = e.Stream;
+            reused &= ReferenceEquals(first, e) && ReferenceEquals(s, e.Stream) && s.Position == 0 && e.PathUtf8[0] == (byte)'f';
+            total += s.Read(buffer) + e.Size;
+        }
+        return (count, total, reused, GC.GetAllocatedBytesForCurrentThread() - allocated);
+    }
+
+    [Test]
+    public void OpenPrefetchedSkipsWithinReadAhead()
+    {
+        using var temp = new TempDirectory();
+        var path = temp["test.tar"];
+        var random = new Random(5);
+        using (var writer = new LibArchiveWriter(path, ArchiveFormat.Tar))
+            for (var i = 0; i < 200; i++)
+            {
+                var data = new byte[random.Next(0, 40_000)];
+                random.NextBytes(data);
+                writer.AddFile($"f{i}", data);
+            }
+
+        // Skip every other entry, some within the blocks in flight and some beyond them
+        static List<string> Read(LibArchiveReader lar) =>
+            lar.Entries().Where((_, i) => i % 2 == 0).Select(e => $"{e.Name} {Convert.ToHexString(SHA256.HashData(e.ReadAllBytes()))}").ToList();
+        using var expected = new LibArchiveReader(path);
+        using var lar = LibArchiveReader.OpenPrefetched(path, 3, 16384);
+        CollectionAssert.AreEqual(Read(expected), Read(lar));
+        Assert.AreEqual(200, lar.Statistics.Headers);
+    }
+
+    [Test]
+    public void OpenSplitNonSeekableStreams()
+    {
+        using var compressed = new MemoryStream();
+        using (var gz = new GZipStream(compressed, CompressionLevel.Fastest, true))
+            gz.Write(File.ReadAllBytes("sparse.tar"));
+        var data = compressed.ToArray();
+        var volumes = new[] { data[..100], data[100..(data.Length - 10)], data[(data.Length - 10)..] }
+            .Select(part => new GZipStream(Compress(part), CompressionMode.Decompress));
+        using var lar = new LibArchiveReader(volumes, 4096);
+        CollectionAssert.AreEqual(new[] { SparseLength }, lar.Entries().Select(e => e.ReadAllBytes().Length));
+        Assert.AreEqual(1, lar.Statistics.Headers);
+    }
+
+    private static MemoryStream Compress(byte[] data)
+    {
+        var compressed = new MemoryStream();
+        using (var gz = new GZipStream(compressed, CompressionLevel.Fastest, true))
+            gz.Write(data);
+        compressed.Position = 0;
+        return compressed;
+    }
+
+    [Test]
+    public void SkipErrorsPropagate()
+    {
+        using var tar = new MemoryStream();
+        using (var writer = new LibArchiveWriter(tar, ArchiveFormat.Tar, leaveOpen: true))
+            for (var i = 0; i < 5; i++)
+                writer.AddFile($"f{i}", new byte[100_000]);
+
+        // Listing skips each entry's data; the second skip fails, and the rest of the archive is not
+        // read in its place
+        var failure = new IOException("The source failed");
+        using var lar = new LibArchiveReader(new SeekFailingStream(tar.ToArray(), 1, failure), 4096);
+        var names = new List<string>();
+        var e = Assert.Throws<IOException>(() =>
+        {
+            foreach (var entry in lar.Entries())
+                names.Add(entry.Name);
+        });
+        Assert.AreSame(failure, e);
+        CollectionAssert.AreEqual(new[] { "f0", "f1" }, names);
+    }
+
+    [Test]
+    public void OpenFromNonSeekableStream()
+    {
+        using var compressed = new MemoryStream();
+        using (var gz = new GZipStream(compressed, CompressionLevel.Fastest, true))
+            gz.Write(File.ReadAllBytes("sparse.tar"));
+        compressed.Position = 0;
+        using var lar = new LibArchiveReader(new GZipStream(compressed, CompressionMode.Decompress), 4096);
+        var names = lar.Entries().Select(e => e.Name).ToList();
+        CollectionAssert.AreEqual(new[] { "sparse" }, names);
+    }
+
+    /// <summary>
+    /// A MemoryStream which throws failure from every seek after the first seeks
+    /// </summary>
+    private sealed class SeekFailingStream : MemoryStream
+    {
+        private readonly Exception _failure;
+        private int _seeks;
+
+        public SeekFailingStream(byte[] data, int seeks, Exception failure) : base(data, false)
+        {
+            _seeks = seeks;
+            _failure = failure;
+        }
+
+        public override long Position
+        {
+            get => base.Position;
+            set => base.Position = Seek(value, SeekOrigin.Begin);
+        }
+
+        public override long Seek(long offset, SeekOrigin loc)
+        {
+            if (_seeks-- <= 0)
+                throw _failure;
+            return base.Seek(offset, loc);
+        }
+    }
+}
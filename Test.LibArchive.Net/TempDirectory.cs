@@ -0,0 +1,47 @@
+namespace Test.LibArchive.Net;
+
+/// <summary>
+/// A new, empty directory under the system temp directory, deleted with everything in it on Dispose
+/// </summary>
+public sealed class TempDirectory : IDisposable
+{
+    public TempDirectory()
+    {
+        Path = System.IO.Path.Combine(System.IO.Path.GetTempPath(), $"libarchive-net-{Guid.NewGuid():N}");
+        Directory.CreateDirectory(Path);
+    }
+
+    public string Path { get; }
+
+    /// <summary>
+    /// The path of name within the directory
+    /// </summary>
+    public string this[string name] => System.IO.Path.Combine(Path, name);
+
+    public void Dispose()
+    {
+        Directory.Delete(Path, true);
+    }
+}
+
+/// <summary>
+/// Base for fixtures whose tests each get a fresh TempDirectory, as Dir
+/// </summary>
+public abstract class TempDirectoryTests
+{
+    private TempDirectory _temp = null!;
+
+    protected string Dir => _temp.Path;
+
+    [SetUp]
+    public void CreateTempDirectory()
+    {
+        _temp = new TempDirectory();
+    }
+
+    [TearDown]
+    public void DeleteTempDirectory()
+    {
+        _temp.Dispose();
+    }
+}
@@ -0,0 +1,120 @@
+using System.IO.Compression;
+using System.Text;
+using LibArchive.Net;
+
+namespace Test.LibArchive.Net;
+
+public class WriterTests
+{
+    private static readonly DateTimeOffset Stamp = DateTimeOffset.FromUnixTimeSeconds(1_600_000_000);
+
+    [TestCase(ArchiveFormat.Tar, ArchiveFilter.Zstd, 2)]
+    [TestCase(ArchiveFormat.Tar, ArchiveFilter.Xz, 2)]
+    [TestCase(ArchiveFormat.Tar, ArchiveFilter.Gzip, 0)]
+    [TestCase(ArchiveFormat.Cpio, ArchiveFilter.Bzip2, 0)]
+    [TestCase(ArchiveFormat.Zip, ArchiveFilter.None, 0)]
+    [TestCase(ArchiveFormat.SevenZip, ArchiveFilter.None, 0)]
+    public void RoundTripThroughStream(ArchiveFormat format, ArchiveFilter filter, int threads)
+    {
+        var files = Files();
+        using var output = new MemoryStream();
+        using (var writer = new LibArchiveWriter(output, format, filter, threads: threads, leaveOpen: true))
+        {
+            writer.AddDirectory("dir", Stamp);
+            foreach (var (name, data) in files)
+            {
+                if (name.EndsWith(".stream"))
+                    writer.AddFile(name, new GZipStream(Compress(data), CompressionMode.Decompress), lastModified: Stamp);
+                else
+                    writer.AddFile(name, data, Stamp);
+            }
+            writer.Finish();
+        }
+
+        using var lar = new LibArchiveReader(output.ToArray());
+        var read = new Dictionary<string, byte[]>();
+        foreach (var e in lar.Entries())
+        {
+            Assert.AreEqual(Stamp, e.LastModified);
+            if (e.Type == EntryType.Directory)
+            {
+                Assert.AreEqual("dir", e.Name.TrimEnd('/'));
+                Assert.AreEqual(0x1ED, e.Permissions);
+                continue;
+            }
+            Assert.AreEqual(0x1A4, e.Permissions);
+            using var ms = new MemoryStream();
+            e.Stream.CopyTo(ms);
+            read.Add(e.Name, ms.ToArray());
+        }
+        CollectionAssert.AreEquivalent(files.Keys, read.Keys);
+        foreach (var (name, data) in files)
+            CollectionAssert.AreEqual(data, read[name], name);
+    }
+
+    [Test]
+    public void RoundTripThroughFile()
+    {
+        using var temp = new TempDirectory();
+        var path = temp["test.tar.zst"];
+        var files = Files();
+        using (var writer = new LibArchiveWriter(path, ArchiveFormat.Tar, ArchiveFilter.Zstd, compressionLevel: 19, threads: 2))
+        {
+            foreach (var (name, data) in files)
+                writer.AddFile(name, new MemoryStream(data));
+            writer.Finish();
+        }
+
+        using var lar = new LibArchiveReader(path);
+        foreach (var e in lar.Entries())
+        {
+            using var ms = new MemoryStream();
+            e.Stream.CopyTo(ms);
+            CollectionAssert.AreEqual(files[e.Name], ms.ToArray(), e.Name);
+        }
+    }
+
+    [Test]
+    public void UnsupportedOptionsThrow()
+    {
+        Assert.Throws<ArchiveException>(() => new LibArchiveWriter(Stream.Null, ArchiveFormat.Tar, ArchiveFilter.Gzip, threads: 4));
+        Assert.Throws<ArchiveException>(() => new LibArchiveWriter(Stream.Null, ArchiveFormat.Zip, options: "zip:no-such-option=1"));
+    }
+
+    [Test]
+    public void SinkErrorsPropagate()
+    {
+        using var full = new MemoryStream(new byte[4096]);
+        Assert.Throws<NotSupportedException>(() =>
+        {
+            using var writer = new LibArchiveWriter(full, ArchiveFormat.Tar, blockSize: 1024);
+            writer.AddFile("big", new byte[1 << 16]);
+            writer.Finish();
+        });
+    }
+
+    private static Dictionary<string, byte[]> Files()
+    {
+        var random = new Random(3);
+        var files = new Dictionary<string, byte[]>();
+        for (var i = 0; i < 6; i++)
+        {
+            var data = new byte[random.Next(0, 300_000)];
+            if (i % 2 == 0)
+                random.NextBytes(data);
+            else
+                Encoding.ASCII.GetBytes(string.Concat(Enumerable.Repeat("compressible text ", data.Length / 18 + 1)).AsSpan(0, data.Length), data);
+            files[i == 5 ? $"dir/file{i}.stream" : $"dir/file{i}.bin"] = data;
+        }
+        return files;
+    }
+
+    private static MemoryStream Compress(byte[] data)
+    {
+        var ms = new MemoryStream();
+        using (var gz = new GZipStream(ms, CompressionLevel.Fastest, true))
+            gz.Write(data);
+        ms.Position = 0;
+        return ms;
+    }
+}
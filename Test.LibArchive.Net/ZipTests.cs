@@ -0,0 +1,111 @@
+using System.Collections.Concurrent;
+using System.IO.Compression;
+using System.Security.Cryptography;
+using LibArchive.Net;
+
+namespace Test.LibArchive.Net;
+
+public class ZipTests
+{
+    private TempDirectory _dir = null!;
+    private string _zip = null!;
+
+    [OneTimeSetUp]
+    public void CreateZip()
+    {
+        _dir = new TempDirectory();
+        _zip = _dir["test.zip"];
+        var random = new Random(1);
+        using var zip = ZipFile.Open(_zip, ZipArchiveMode.Create);
+        for (var i = 0; i < 200; i++)
+        {
+            var data = new byte[random.Next(0, 64 << 10)];
+            random.NextBytes(data.AsSpan(0, data.Length / 2));
+            using var s = zip.CreateEntry($"dir{i % 7}/file{i}.bin").Open();
+            s.Write(data);
+        }
+    }
+
+    [OneTimeTearDown]
+    public void Cleanup()
+    {
+        _dir.Dispose();
+    }
+
+    [Test]
+    public void ParallelProcessMatchesSequential()
+    {
+        var expected = new Dictionary<string, string>();
+        using (var lar = new LibArchiveReader(_zip))
+            foreach (var e in lar.Entries())
+                expected[e.Name] = Hash(e.Stream);
+
+        var actual = new ConcurrentDictionary<string, string>();
+        new ArchiveExtractor(_zip, 4).Process(e => actual[e.Name] = Hash(e.Stream));
+        CollectionAssert.AreEquivalent(expected, actual);
+    }
+
+    [Test]
+    public void ParallelHashesMatchStreams()
+    {
+        var expected = new Dictionary<string, string>();
+        using (var lar = new LibArchiveReader(_zip))
+            foreach (var e in lar.Entries())
+                if (e.Type == EntryType.File)
+                    expected[e.Name] = Hash(e.Stream);
+
+        var actual = new ArchiveExtractor(_zip, 4).ComputeHashes(HashAlgorithmName.SHA256);
+        CollectionAssert.AreEquivalent(expected, actual.ToDictionary(h => h.Key, h => Convert.ToHexString(h.Value)));
+    }
+
+    [Test]
+    public void ExtractToWritesEveryFile()
+    {
+        var target = _dir["out"];
+        new ArchiveExtractor(_zip, 4).ExtractTo(target);
+        using var zip = ZipFile.OpenRead(_zip);
+        foreach (var e in zip.Entries)
+        {
+            using var s = e.Open();
+            using var ms = new MemoryStream();
+            s.CopyTo(ms);
+            CollectionAssert.AreEqual(ms.ToArray(), File.ReadAllBytes(Path.Combine(target, e.FullName)));
+        }
+    }
+
+    [Test]
+    public void ExtractToRejectsEscapingPaths()
+    {
+        var evil = _dir["evil.zip"];
+        using (var zip = ZipFile.Open(evil, ZipArchiveMode.Create))
+        using (var s = zip.CreateEntry("../escaped").Open())
+            s.WriteByte(1);
+        Assert.Throws<IOException>(() => new ArchiveExtractor(evil).ExtractTo(_dir["evil"]));
+        Assert.IsFalse(File.Exists(_dir["escaped"]));
+    }
+
+    [Test]
+    public void PathFilterSkipsRejectedEntries()
+    {
+        using var lar = new LibArchiveReader(_zip);
+        var names = lar.Entries(EntryFilter.StartsWith("dir3/", "dir5/file5.")).Select(e => e.Name).ToList();
+        Assert.AreEqual(30, names.Count);
+        Assert.IsTrue(names.All(n => n.StartsWith("dir3/") || n == "dir5/file5.bin"));
+    }
+
+    [Test]
+    public void EntryFilterUsesNativePatterns()
+    {
+        using var filter = new EntryFilter().Include("dir1").Exclude("*7.bin");
+        using var lar = new LibArchiveReader(_zip);
+        var names = lar.Entries(filter).Select(e => e.Name).ToList();
+        Assert.AreEqual(26, names.Count);
+        Assert.IsTrue(names.All(n => n.StartsWith("dir1/") && !n.EndsWith("7.bin")));
+    }
+
+    private static string Hash(Stream s)
+    {
+        using var sha = SHA256.Create();
+        return Convert.ToHexString(sha.ComputeHash(s));
+    }
+}
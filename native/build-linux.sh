@@ -1,14 +1,25 @@
 #!/bin/sh
 
+# PROFILE=performance builds zlib-ng in zlib-compatible mode (SIMD inflate and deflate, chosen at
+# run time from the CPU's AVX2/AVX-512/PCLMUL support) in place of zlib, and compiles libarchive
+# and every codec at -O3 with link-time optimisation across the static archives. PGO=1 then also
+# trains an instrumented build by decoding the archives in PGO_CORPUS (default: sample archives
+# made from the sources here) and rebuilds everything with that profile.
+#
+# The library is built for the host's architecture (x86_64 or aarch64); it links musl statically,
+# so the one build serves glibc and musl distributions alike. LEVEL=v3 targets x86-64-v3 (AVX2,
+# BMI1/2, FMA, F16C, LZCNT, MOVBE), which the .Net resolver prefers on CPUs that have them.
+
 set -e
 export NCPU=`nproc`
+export TARGET=`uname -m`-linux-musl
 export CONFIGCACHE=`pwd`/configcache
 export PREFIX=`pwd`/local
-export CPPFLAGS="-I$PREFIX/include -I$PREFIX/x86_64-linux-musl/include -I$PREFIX/lib/gcc/x86_64-linux-musl/9.2.0/include"
+export CPPFLAGS="-I$PREFIX/include -I$PREFIX/$TARGET/include -I$PREFIX/lib/gcc/$TARGET/9.2.0/include"
 export CFLAGS="-fPIC -O2 $CPPFLAGS -static-libgcc"
-export CXXFLAGS="-fPIC -O2 -I$PREFIX/x86_64-linux-musl/include/c++/9.2.0 -I$PREFIX/x86_64-linux-musl/include/c++/9.2.0/x86_64-linux-musl $CPPFLAGS -static-libstdc++ -static-libgcc -include sys/time.h"
+export CXXFLAGS="-fPIC -O2 -I$PREFIX/$TARGET/include/c++/9.2.0 -I$PREFIX/$TARGET/include/c++/9.2.0/$TARGET $CPPFLAGS -static-libstdc++ -static-libgcc -include sys/time.h"
 export LDFLAGS="-L$PREFIX/lib -static"
-export PATH="$PREFIX/bin:$PREFIX/x86_64-linux-musl/bin:$PATH"
+export PATH="$PREFIX/bin:$PREFIX/$TARGET/bin:$PATH"
 
 curl -sL https://github.com/richfelker/musl-cross-make/archive/refs/heads/master.zip > musl-git.zip
 unzip musl-git.zip
@@ -19,49 +30,115 @@ curl -sL https://github.com/facebook/zstd/releases/download/v1.5.2/zstd-1.5.2.ta
 curl -sL http://www.oberhumer.com/opensource/lzo/download/lzo-2.10.tar.gz | tar xzf -
 curl -sL https://gitlab.gnome.org/GNOME/libxml2/-/archive/v2.10.3/libxml2-v2.10.3.tar.bz2 | tar xjf -
 curl -sL https://www.sourceware.org/pub/bzip2/bzip2-latest.tar.gz | tar xzf -
-curl -sL https://zlib.net/zlib-1.2.13.tar.xz | tar xJf -
 curl -sL https://tukaani.org/xz/xz-5.4.0.tar.xz | tar xJf -
+if [ "$PROFILE" = performance ]; then
+  curl -sL https://github.com/zlib-ng/zlib-ng/archive/refs/tags/2.1.6.tar.gz | tar xzf -
+else
+  curl -sL https://zlib.net/zlib-1.2.13.tar.xz | tar xJf -
+fi
 
 cd musl-cross-make-master
 cat > config.mak <<EOC
-TARGET=x86_64-linux-musl
+TARGET=$TARGET
 COMMON_CONFIG += --disable-nls
 GCC_CONFIG += --disable-libitm
 GCC_CONFIG += --enable-default-pie
 EOC
 make -sj$NCPU install OUTPUT=$PREFIX 2>&1 >musl.log || cat musl.log
 
-export CC=x86_64-linux-musl-gcc
-export CXX=x86_64-linux-musl-g++
+export CC=$TARGET-gcc
+export CXX=$TARGET-g++
 cd ..
-make -j$NCPU -sC lz4-1.9.4 install
-make -j$NCPU -sC zstd-1.5.2 install
-make -j$NCPU -sC bzip2-1.0.8 install PREFIX=$PREFIX CFLAGS="-fPIC -O2 -D_FILE_OFFSET_BITS=64" CC=$CC
 
-cd lzo-2.10
-./configure --cache-file=$CONFIGCACHE --prefix=$PREFIX
-make -sj$NCPU install
+if [ "$PROFILE" = performance ]; then
+  # The LTO plugin wrappers, so the static archives index the objects' intermediate code; fat
+  # objects keep the host gcc link of nativetest working
+  export AR=$TARGET-gcc-ar
+  export RANLIB=$TARGET-gcc-ranlib
+  export NM=$TARGET-gcc-nm
+  export CONFIGCACHE=`pwd`/configcache-performance
+  OPT="-O3 -flto=$NCPU -ffat-lto-objects"
+  ZLIB=zlib-ng-2.1.6
+  ZLIBCONFIG="--zlib-compat --static"
+  ZLIBDIR=$PREFIX
+  LINK="$CC $OPT"
+else
+  OPT=-O2
+  ZLIB=zlib-1.2.13
+  ZLIBCONFIG=--static
+  ZLIBDIR=$PREFIX/../zlib-1.2.13
+  LINK=gcc
+fi
+if [ "$LEVEL" = v3 ]; then
+  # gcc 9 predates -march=x86-64-v3, so spell out its extensions
+  OPT="$OPT -march=x86-64 -mtune=generic -mcx16 -msahf -mpopcnt -msse3 -mssse3 -msse4.1 -msse4.2 -mavx -mavx2 -mbmi -mbmi2 -mf16c -mfma -mlzcnt -mmovbe -mxsave"
+fi
 
-cd ../zlib-1.2.13
-./configure --static --prefix=$PREFIX
-make -sj$NCPU install
+# Build the codecs and libarchive into $PREFIX, with $1 as extra compiler flags
+build() {
+  export CFLAGS="-fPIC $OPT $1 $CPPFLAGS -static-libgcc"
+  export CXXFLAGS="-fPIC $OPT $1 -I$PREFIX/$TARGET/include/c++/9.2.0 -I$PREFIX/$TARGET/include/c++/9.2.0/$TARGET $CPPFLAGS -static-libstdc++ -static-libgcc -include sys/time.h"
+  make -j$NCPU -sC lz4-1.9.4 install
+  make -j$NCPU -sC zstd-1.5.2 install BUILD_DIR=obj/local
+  make -j$NCPU -sC bzip2-1.0.8 install PREFIX=$PREFIX CFLAGS="-fPIC $OPT $1 -D_FILE_OFFSET_BITS=64" CC=$CC AR=${AR:-ar} RANLIB=${RANLIB:-ranlib}
 
-cd ../xz-5.4.0
-./configure --cache-file=$CONFIGCACHE --with-pic --disable-shared --prefix=$PREFIX
-make -sj$NCPU install
+  cd lzo-2.10
+  ./configure --cache-file=$CONFIGCACHE --prefix=$PREFIX
+  make -sj$NCPU install
 
-cd ../libxml2-v2.10.3
-./autogen.sh --cache-file=$CONFIGCACHE --enable-silent-rules --disable-shared --enable-static --prefix=$PREFIX --without-python --with-zlib=$PREFIX/../zlib-1.2.13 --with-lzma=$PREFIX/../xz-5.4.0
-make -sj$NCPU install
+  cd ../$ZLIB
+  ./configure $ZLIBCONFIG --prefix=$PREFIX
+  make -sj$NCPU install
 
-cd ../libarchive-*
-export LIBXML2_PC_CFLAGS=-I$PREFIX/include/libxml2
-export LIBXML2_PC_LIBS=-L$PREFIX
-./configure --cache-file=$CONFIGCACHE --prefix=$PREFIX --disable-bsdtar --disable-bsdcat --disable-bsdcpio --enable-posix-regex-lib=libc --with-pic --with-sysroot --with-lzo2
-make -sj$NCPU install
+  cd ../xz-5.4.0
+  ./configure --cache-file=$CONFIGCACHE --with-pic --disable-shared --prefix=$PREFIX
+  make -sj$NCPU install
 
-cd ..
-gcc -shared -o libarchive.so -Wl,--whole-archive local/lib/libarchive.a -Wl,--no-whole-archive local/lib/libbz2.a local/lib/libz.a local/lib/libxml2.a local/lib/liblzma.a local/lib/liblzo2.a local/lib/libzstd.a local/lib/liblz4.a local/x86_64-linux-musl/lib/libc.a -nostdlib
+  cd ../libxml2-v2.10.3
+  ./autogen.sh --cache-file=$CONFIGCACHE --enable-silent-rules --disable-shared --enable-static --prefix=$PREFIX --without-python --with-zlib=$ZLIBDIR --with-lzma=$PREFIX/../xz-5.4.0
+  make -sj$NCPU install
+
+  cd ../libarchive-*
+  export LIBXML2_PC_CFLAGS=-I$PREFIX/include/libxml2
+  export LIBXML2_PC_LIBS=-L$PREFIX
+  ./configure --cache-file=$CONFIGCACHE --prefix=$PREFIX --disable-bsdtar --disable-bsdcat --disable-bsdcpio --enable-posix-regex-lib=libc --with-pic --with-sysroot --with-lzo2
+  make -sj$NCPU install
+  cd ..
+}
+
+# Sample archives for training and validation: PGO_CORPUS if set, else the sources here compressed
+# with each common filter
+corpus() {
+  if [ -z "$PGO_CORPUS" ]; then
+    PGO_CORPUS=`pwd`/corpus
+    mkdir -p $PGO_CORPUS
+    tar cf $PGO_CORPUS/sources.tar libarchive-3.6.2 libxml2-v2.10.3 xz-5.4.0 zstd-1.5.2 lz4-1.9.4
+    gzip -9c $PGO_CORPUS/sources.tar > $PGO_CORPUS/sources.tar.gz
+    bzip2 -9c $PGO_CORPUS/sources.tar > $PGO_CORPUS/sources.tar.bz2
+    xz -6c $PGO_CORPUS/sources.tar > $PGO_CORPUS/sources.tar.xz
+    zstd -19 -qc $PGO_CORPUS/sources.tar > $PGO_CORPUS/sources.tar.zst
+    lz4 -9 -qc $PGO_CORPUS/sources.tar > $PGO_CORPUS/sources.tar.lz4
+  fi
+  SAMPLES=`ls -d $PGO_CORPUS/*`
+}
+
+if [ "$PROFILE" = performance ] && [ "$PGO" = 1 ]; then
+  build -fprofile-generate
+  corpus
+  $CC -static $CFLAGS -o nativetest-train native/nativetest.c -Ilocal/include -Llocal/lib -larchive -lxml2 -llzma -llzo2 -lzstd -llz4 -lbz2 -lz
+  ./nativetest-train $SAMPLES
+  # Rebuild every object against the .gcda files the training run left beside it
+  find lz4-1.9.4 zstd-1.5.2 bzip2-1.0.8 lzo-2.10 $ZLIB xz-5.4.0 libxml2-v2.10.3 libarchive-3.6.2 \( -name '*.o' -o -name '*.lo' -o -name '*.a' -o -name '*.la' \) -delete
+  export CONFIGCACHE=`pwd`/configcache-pgo
+  build "-fprofile-use -fprofile-correction -Wno-missing-profile"
+else
+  build
+fi
+if [ "$PROFILE" = performance ]; then
+  corpus
+fi
+
+$LINK -shared -o libarchive.so -Wl,--whole-archive local/lib/libarchive.a -Wl,--no-whole-archive local/lib/libbz2.a local/lib/libz.a local/lib/libxml2.a local/lib/liblzma.a local/lib/liblzo2.a local/lib/libzstd.a local/lib/liblz4.a local/$TARGET/lib/libc.a -nostdlib
 
 cat > test.c <<EOT
 #include <stdio.h>
@@ -77,4 +154,4 @@ file libarchive.so
 ldd libarchive.so
 
 gcc -o nativetest native/nativetest.c local/lib/libarchive.a -Llocal/lib -Ilocal/include -llz4 -lzstd -lbz2
-./nativetest
+./nativetest $SAMPLES
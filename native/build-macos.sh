@@ -1,5 +1,10 @@
 #!/bin/sh
 
+# PROFILE=performance builds zlib-ng in zlib-compatible mode (NEON on arm64, AVX2 and SSE chosen at
+# run time on x86-64) in place of zlib, and compiles libarchive and every codec at -O3 with
+# link-time optimisation. PGO is only offered by build-linux.sh, since a universal library's
+# training run would only profile the host's slice.
+
 set -e
 
 brew install autoconf automake
@@ -9,7 +14,17 @@ export NCPU=`sysctl -n hw.ncpu`
 export CONFIGCACHE=`pwd`/configcache
 export CPPFLAGS="-I$PREFIX/include"
 export LDFLAGS="-L$PREFIX/lib -liconv"
-export CFLAGS="-fPIC -O2 -D_FILE_OFFSET_BITS=64 -arch arm64 -arch x86_64"
+if [ "$PROFILE" = performance ]; then
+  export CONFIGCACHE=`pwd`/configcache-performance
+  OPT="-O3 -flto=thin"
+  ZLIB=zlib-ng-2.1.6
+  ZLIBDIR=$PREFIX
+else
+  OPT=-O2
+  ZLIB=zlib-1.2.13
+  ZLIBDIR=$PREFIX/../zlib-1.2.13
+fi
+export CFLAGS="-fPIC $OPT -D_FILE_OFFSET_BITS=64 -arch arm64 -arch x86_64"
 
 curl -sL https://github.com/libarchive/libarchive/releases/download/v3.6.2/libarchive-3.6.2.tar.xz | tar xJf -
 curl -sL https://github.com/lz4/lz4/archive/refs/tags/v1.9.4.tar.gz | tar xzf -
@@ -17,8 +32,12 @@ curl -sL https://github.com/facebook/zstd/releases/download/v1.5.2/zstd-1.5.2.ta
 curl -sL http://www.oberhumer.com/opensource/lzo/download/lzo-2.10.tar.gz | tar xzf -
 curl -sL https://gitlab.gnome.org/GNOME/libxml2/-/archive/v2.10.3/libxml2-v2.10.3.tar.bz2 | tar xjf -
 curl -sL https://www.sourceware.org/pub/bzip2/bzip2-latest.tar.gz | tar xzf -
-curl -sL https://zlib.net/zlib-1.2.13.tar.xz | tar xJf -
 curl -sL https://tukaani.org/xz/xz-5.4.0.tar.xz | tar xJf -
+if [ "$PROFILE" = performance ]; then
+  curl -sL https://github.com/zlib-ng/zlib-ng/archive/refs/tags/2.1.6.tar.gz | tar xzf -
+else
+  curl -sL https://zlib.net/zlib-1.2.13.tar.xz | tar xJf -
+fi
 
 make -j$NCPU -sC lz4-1.9.4 install PREFIX=$PREFIX CFLAGS="$CFLAGS"
 make -j$NCPU -sC bzip2-1.0.8 install PREFIX=$PREFIX CFLAGS="$CFLAGS"
@@ -27,14 +46,24 @@ cd lzo-2.10
 ./configure --cache-file=$CONFIGCACHE --prefix=$PREFIX
 make -sj$NCPU install
 
-cd ../zlib-1.2.13
-./configure --static --prefix=$PREFIX
-make -sj$NCPU install
+cd ../$ZLIB
+if [ "$PROFILE" = performance ]; then
+  # zlib-ng selects its SIMD sources per architecture, so build each slice alone and join them
+  for arch in arm64 x86_64; do
+    cmake -S . -B build-$arch -DCMAKE_BUILD_TYPE=Release -DCMAKE_OSX_ARCHITECTURES=$arch -DCMAKE_C_FLAGS="-fPIC $OPT" -DCMAKE_INSTALL_PREFIX=$PREFIX -DZLIB_COMPAT=ON -DBUILD_SHARED_LIBS=OFF -DZLIB_ENABLE_TESTS=OFF
+    cmake --build build-$arch -j$NCPU
+  done
+  cmake --install build-arm64
+  lipo -create -output $PREFIX/lib/libz.a build-arm64/libz.a build-x86_64/libz.a
+else
+  ./configure --static --prefix=$PREFIX
+  make -sj$NCPU install
+fi
 cd ../xz-5.4.0
 ./configure --cache-file=$CONFIGCACHE --with-pic --disable-shared --prefix=$PREFIX
 make -sj$NCPU install
 cd ../libxml2-v2.10.3
-./autogen.sh --enable-silent-rules --disable-shared --enable-static --prefix=$PREFIX --without-python --with-zlib=$PREFIX/../zlib-1.2.13 --with-lzma=$PREFIX/../xz-5.4.0
+./autogen.sh --enable-silent-rules --disable-shared --enable-static --prefix=$PREFIX --without-python --with-zlib=$ZLIBDIR --with-lzma=$PREFIX/../xz-5.4.0
 make -sj$NCPU install
 
 make -j$NCPU -sC ../zstd-1.5.2 install
@@ -46,6 +75,14 @@ export LIBXML2_PC_LIBS="-L$PREFIX -lxml2"
 make -sj$NCPU install
 cd ..
 
-clang -arch arm64 -arch x86_64 -dynamiclib -shared -o libarchive.dylib -Wl,-force_load local/lib/libarchive.a local/lib/libbz2.a local/lib/libz.a local/lib/libxml2.a local/lib/liblzma.a local/lib/liblzo2.a local/lib/libzstd.a local/lib/liblz4.a -liconv
+clang $OPT -arch arm64 -arch x86_64 -dynamiclib -shared -o libarchive.dylib -Wl,-force_load local/lib/libarchive.a local/lib/libbz2.a local/lib/libz.a local/lib/libxml2.a local/lib/liblzma.a local/lib/liblzo2.a local/lib/libzstd.a local/lib/liblz4.a -liconv
 gcc -o nativetest native/nativetest.c local/lib/libarchive.a -Llocal/lib -Ilocal/include -llz4 -lzstd -liconv -lbz2
-./nativetest
+if [ "$PROFILE" = performance ]; then
+  mkdir -p corpus
+  tar cf corpus/sources.tar libarchive-3.6.2 libxml2-v2.10.3 xz-5.4.0 zstd-1.5.2 lz4-1.9.4
+  gzip -9c corpus/sources.tar > corpus/sources.tar.gz
+  bzip2 -9c corpus/sources.tar > corpus/sources.tar.bz2
+  xz -6c corpus/sources.tar > corpus/sources.tar.xz
+  SAMPLES=`ls -d corpus/*`
+fi
+./nativetest $SAMPLES